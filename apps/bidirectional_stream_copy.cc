@@ -4,7 +4,9 @@
 #include "eventloop.hh"
 
 #include <iostream>
+#include <span>
 #include <unistd.h>
+#include <vector>
 
 using namespace std;
 
@@ -15,10 +17,12 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   EventLoop eventloop {};
   FileDescriptor input { STDIN_FILENO };
   FileDescriptor output { STDOUT_FILENO };
-  ByteStream outbound { buffer_size };
-  ByteStream inbound { buffer_size };
+  ByteStream outbound { buffer_size, ByteStream::Storage::Ring };
+  ByteStream inbound { buffer_size, ByteStream::Storage::Ring };
   bool outbound_shutdown { false };
   bool inbound_shutdown { false };
+  vector<string_view> buffers;
+  vector<span<char>> spans;
 
   socket.set_blocking( false );
   input.set_blocking( false );
@@ -30,10 +34,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( outbound.writer().available_capacity() );
-      input.read( data );
-      outbound.writer().push( move( data ) );
+      outbound.writer().reserve( outbound.writer().available_capacity(), spans );
+      outbound.writer().commit( input.read( spans ) );
       if ( input.eof() ) {
         outbound.writer().close();
       }
@@ -56,7 +58,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( outbound.reader().bytes_buffered() ) {
-        outbound.reader().pop( socket.write( outbound.reader().peek() ) );
+        outbound.reader().peek( outbound.reader().bytes_buffered(), buffers );
+        outbound.reader().pop( socket.write( buffers ) );
       }
       if ( outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -80,10 +83,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( inbound.writer().available_capacity() );
-      socket.read( data );
-      inbound.writer().push( move( data ) );
+      inbound.writer().reserve( inbound.writer().available_capacity(), spans );
+      inbound.writer().commit( socket.read( spans ) );
       if ( socket.eof() ) {
         inbound.writer().close();
       }
@@ -106,7 +107,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( inbound.reader().bytes_buffered() ) {
-        inbound.reader().pop( output.write( inbound.reader().peek() ) );
+        inbound.reader().peek( inbound.reader().bytes_buffered(), buffers );
+        inbound.reader().pop( output.write( buffers ) );
       }
       if ( inbound.reader().is_finished() ) {
         output.close();
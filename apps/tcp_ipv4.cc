@@ -35,6 +35,8 @@ void show_usage( const char* argv0, const char* msg )
 
        << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
+       << "   -N              Coalesce small writes (Nagle's algorithm)       (no delay)\n\n"
+
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
@@ -96,6 +98,10 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-N", args[curr], 3 ) == 0 ) {
+      c_fsm.no_delay = false;
+      curr += 1;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -6,3 +6,9 @@ set(SANITIZING_FLAGS -fno-sanitize-recover=all -fsanitize=undefined -fsanitize=a
 # ask for more warnings from the compiler
 set (CMAKE_BASE_CXX_FLAGS "${CMAKE_CXX_FLAGS}")
 set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wall -Wpedantic -Wextra -Weffc++ -Werror -Wshadow -Wpointer-arith -Wcast-qual -Wformat=2 -Wno-unqualified-std-cast-call -Wno-non-virtual-dtor -DHAVE_WRAP32 -DHAVE_TCP_SENDER_MESSAGE")
+
+# record ByteStream usage statistics (see src/byte_stream_stats.hh)
+option (MINNOW_STREAM_STATS "Record ByteStream usage statistics" OFF)
+if (MINNOW_STREAM_STATS)
+  add_compile_definitions (MINNOW_STREAM_STATS=1)
+endif ()
@@ -23,6 +23,15 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_ring)
+ttest(byte_stream_peek_vectored)
+ttest(byte_stream_reserve)
+ttest(byte_stream_concurrent)
+ttest(byte_stream_splice)
+ttest(byte_stream_spill)
+ttest(byte_stream_stats)
+ttest(byte_stream_small_writes)
+ttest(byte_stream_records)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,6 +40,8 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_ring)
+ttest(reassembler_limits)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
@@ -45,6 +56,10 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
+ttest(recv_timestamps)
+ttest(recv_sws)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +68,21 @@ ttest(send_ack)
 ttest(send_close)
 ttest(send_retx)
 ttest(send_extra)
+ttest(send_sack)
+ttest(send_congestion)
+ttest(send_congestion_control)
+ttest(send_rtt)
+ttest(send_fast_retx)
+ttest(send_rack)
+ttest(send_spurious)
+ttest(send_window_scale)
+ttest(send_timestamps)
+ttest(send_mss)
+ttest(send_nagle)
+ttest(send_sws)
+ttest(send_pacing)
+
+ttest(peer_delayed_ack)
 
 ttest(net_interface)
 
@@ -70,7 +100,7 @@ add_custom_target (check1 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --s
 
 add_custom_target (check2 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 15 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^no_skip')
 
-add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 15 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send|^no_skip')
+add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 15 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send|^peer|^no_skip')
 
 add_custom_target (check5 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 15 -R '^net_interface|^no_skip')
 
@@ -94,3 +124,4 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(reassembler_pattern_speed_test)
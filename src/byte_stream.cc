@@ -2,12 +2,17 @@
 #include "debug.hh"
 #include <algorithm>
 #include <cstdint>
+#include <span>
+#include <stdexcept>
 #include <string_view>
+#include <vector>
 
 using namespace std;
 
 // capacity构造
-ByteStream::ByteStream( uint64_t capacity ) : impl_( make_shared<ByteStreamImpl>( capacity ) ) {}
+ByteStream::ByteStream( uint64_t capacity, Storage storage, uint64_t memory_limit )
+  : impl_( make_shared<ByteStreamImpl>( capacity, storage, memory_limit ) )
+{}
 
 // 拷贝构造
 ByteStream::ByteStream( const ByteStream& other ) : impl_( make_shared<ByteStreamImpl>( *other.impl_ ) ) {}
@@ -24,6 +29,9 @@ ByteStream& ByteStream::operator=( const ByteStream& other )
 // 将string类型data压入流，需要检查当前capacity
 void Writer::push( string data )
 {
+  // push会占用reserve()交出的空间，使之前的预留失效
+  impl_->reserved_ = 0;
+
   if ( data.empty() || impl_->end_input_ ) {
     return;
   }
@@ -35,20 +43,115 @@ void Writer::push( string data )
     return;
   }
 
-  if ( len_to_write < data.size() ) {
-    // 传入data需要被resize函数截断
-    data.resize( len_to_write );
+  if ( impl_->ring_ ) {
+    // Ring模式：直接拷贝进环中，不产生新的分配
+    impl_->ring_->write( impl_->written_size_, string_view( data ).substr( 0, len_to_write ) );
+    impl_->written_size_ += len_to_write;
+    impl_->bytes_buffered_ += len_to_write;
+    impl_->stats_.on_write( len_to_write, impl_->bytes_buffered_, impl_->capacity_ );
+    impl_->spill_cold_bytes();
+    return;
+  }
+
+  if ( len_to_write < SMALL_WRITE_SIZE ) {
+    // 小写入拷贝进池化的块中，避免每次push都产生一个分块
+    impl_->append_small( string_view( data ).substr( 0, len_to_write ) );
+  } else {
+    if ( len_to_write < data.size() ) {
+      // 传入data需要被resize函数截断
+      data.resize( len_to_write );
+    }
+    impl_->buffer_.push_back( std::move( data ) );
+    impl_->stats_.on_allocation();
   }
 
-  impl_->buffer_.push_back( std::move( data ) );
   impl_->written_size_ += len_to_write;
   impl_->bytes_buffered_ += len_to_write;
+  impl_->stats_.on_write( len_to_write, impl_->bytes_buffered_, impl_->capacity_ );
+}
+
+void Writer::reserve( uint64_t len, vector<span<char>>& out )
+{
+  out.clear();
+  impl_->reserved_ = 0;
+  impl_->release_reserved_blocks();
+
+  if ( impl_->end_input_ ) {
+    return;
+  }
+
+  uint64_t remaining = min( len, available_capacity() );
+
+  if ( impl_->ring_ ) {
+    impl_->reserved_ = remaining;
+    // Ring模式：直接交出写位置之后的空闲区域（至多两段）
+    uint64_t pos = impl_->written_size_;
+    while ( remaining > 0 ) {
+      const span<char> region = impl_->ring_->span( pos, remaining );
+      out.push_back( region );
+      pos += region.size();
+      remaining -= region.size();
+    }
+    return;
+  }
+
+  // Chunked模式：交出若干池化的块（commit时再挂到deque尾部，避免Reader看到未写入的数据），
+  // 不为整个可用容量一次性分配并清零一个大字符串
+  remaining = min( remaining, MAX_RESERVED_BLOCKS * ChunkPool::BLOCK_SIZE );
+  impl_->reserved_ = remaining;
+  auto& blocks = impl_->reserved_blocks_;
+  while ( remaining > 0 ) {
+    const uint64_t size = min( remaining, uint64_t { ChunkPool::BLOCK_SIZE } );
+    blocks.push_back( impl_->new_block() );
+    blocks.back().resize( size );
+    remaining -= size;
+  }
+  for ( auto& block : blocks ) {
+    out.emplace_back( block.data(), block.size() );
+  }
+}
+
+void Writer::commit( uint64_t len )
+{
+  if ( len > impl_->reserved_ ) {
+    throw runtime_error( "Writer::commit() called with more bytes than were reserved" );
+  }
+  impl_->reserved_ = 0;
+
+  // Chunked模式：写入了数据的块挂到deque尾部，其余的归还给池
+  uint64_t remaining = len;
+  for ( auto& block : impl_->reserved_blocks_ ) {
+    const uint64_t used = min( remaining, static_cast<uint64_t>( block.size() ) );
+    if ( used == 0 ) {
+      break;
+    }
+    block.resize( used );
+    if ( used < SMALL_WRITE_SIZE ) {
+      // 小写入同样合并进尾块
+      impl_->append_small( block );
+    } else {
+      impl_->buffer_.push_back( std::move( block ) );
+      block = string {};
+    }
+    remaining -= used;
+  }
+  impl_->release_reserved_blocks();
+
+  if ( len == 0 ) {
+    return;
+  }
+
+  impl_->written_size_ += len;
+  impl_->bytes_buffered_ += len;
+  impl_->stats_.on_write( len, impl_->bytes_buffered_, impl_->capacity_ );
+  impl_->spill_cold_bytes();
 }
 
 void Writer::close()
 {
   // 不是向deque中写入EOF文件结束符，而是修改流对象状态
   impl_->end_input_ = true;
+  impl_->stats_.on_close();
 }
 
 bool Writer::is_closed() const
@@ -70,6 +173,11 @@ uint64_t Writer::bytes_pushed() const
 
 string_view Reader::peek() const
 {
+  if ( impl_->ring_ ) {
+    // Ring模式：双重映射时一次返回全部已缓存数据
+    return impl_->ring_->view( impl_->read_size_, impl_->bytes_buffered_ );
+  }
+
   if ( impl_->buffer_.empty() ) {
     return {};
   }
@@ -81,6 +189,33 @@ string_view Reader::peek() const
   return sv.substr( impl_->front_offset_ );
 }
 
+void Reader::peek( uint64_t max_len, vector<string_view>& out ) const
+{
+  out.clear();
+  uint64_t remaining = min( max_len, impl_->bytes_buffered_ );
+
+  if ( impl_->ring_ ) {
+    // Ring模式：至多两段（未双重映射时在物理末尾处断开）
+    uint64_t pos = impl_->read_size_;
+    while ( remaining > 0 ) {
+      const string_view view = impl_->ring_->view( pos, remaining );
+      out.push_back( view );
+      pos += view.size();
+      remaining -= view.size();
+    }
+    return;
+  }
+
+  // Chunked模式：逐个分块收集视图，首个分块需去掉已读偏移量
+  uint64_t offset = impl_->front_offset_;
+  for ( auto it = impl_->buffer_.begin(); it != impl_->buffer_.end() && remaining > 0; ++it ) {
+    const string_view view = string_view( *it ).substr( offset, remaining );
+    out.push_back( view );
+    remaining -= view.size();
+    offset = 0;
+  }
+}
+
 void Reader::pop( uint64_t len )
 {
   debug( "pop function was called, arg len: {}", len );
@@ -90,6 +225,13 @@ void Reader::pop( uint64_t len )
   // 在buffer中移除len长度的字节
   impl_->read_size_ += len;
   impl_->bytes_buffered_ -= len; // 确保读取后writer还能写入
+  impl_->stats_.on_pop( len, impl_->bytes_buffered_, impl_->capacity_, impl_->end_input_ );
+
+  // Ring模式下读位置由read_size_推出，无需移动分块
+  if ( impl_->ring_ ) {
+    impl_->discard_popped_bytes();
+    return;
+  }
 
   while ( len > 0 ) {
     const std::string& front_str = impl_->buffer_.front();
@@ -101,7 +243,8 @@ void Reader::pop( uint64_t len )
       impl_->front_offset_ += len;
       len = 0;
     } else {
-      // 要pop的长度大于当前字符串剩余
+      // 要pop的长度大于当前字符串剩余，读完的块归还给池
+      ChunkPool::give( std::move( impl_->buffer_.front() ) );
       impl_->buffer_.pop_front();
       impl_->front_offset_ = 0;
       len -= remain_in_front;
@@ -112,7 +255,7 @@ void Reader::pop( uint64_t len )
 bool Reader::is_finished() const
 {
   // 返回当前流状态：被主动关闭且读取为空
-  return impl_->end_input_ && impl_->buffer_.empty();
+  return impl_->end_input_ && impl_->bytes_buffered_ == 0;
 }
 
 uint64_t Reader::bytes_buffered() const
@@ -124,3 +267,128 @@ uint64_t Reader::bytes_popped() const
 {
   return impl_->read_size_;
 }
+
+uint64_t splice( Reader& from, Writer& to, uint64_t max_len )
+{
+  auto& src = *from.impl_;
+  auto& dst = *to.impl_;
+
+  if ( &src == &dst || dst.end_input_ ) {
+    return 0;
+  }
+
+  const uint64_t len = min( { max_len, src.bytes_buffered_, to.available_capacity() } );
+  dst.reserved_ = 0;
+
+  uint64_t moved = 0;
+  if ( src.ring_ || dst.ring_ ) {
+    // 任一端为Ring模式：直接在两端存储之间拷贝一次
+    while ( moved < len ) {
+      const string_view view = from.peek().substr( 0, len - moved );
+      if ( dst.ring_ ) {
+        dst.ring_->write( dst.written_size_ + moved, view );
+      } else {
+        dst.buffer_.emplace_back( view );
+        dst.stats_.on_allocation();
+      }
+      moved += view.size();
+      from.pop( view.size() );
+    }
+  } else {
+    // 均为Chunked模式：完整分块直接转移所有权，只有首块的已读部分或末块的剩余部分需要拷贝
+    while ( moved < len ) {
+      string& front = src.buffer_.front();
+      const uint64_t remain_in_front = front.size() - src.front_offset_;
+      const uint64_t take = min( remain_in_front, len - moved );
+
+      if ( src.front_offset_ == 0 && take == remain_in_front ) {
+        dst.buffer_.push_back( std::move( front ) );
+      } else {
+        dst.buffer_.push_back( front.substr( src.front_offset_, take ) );
+      }
+      dst.stats_.on_allocation();
+
+      if ( take == remain_in_front ) {
+        src.buffer_.pop_front();
+        src.front_offset_ = 0;
+      } else {
+        src.front_offset_ += take;
+      }
+      moved += take;
+    }
+    src.read_size_ += moved;
+    src.bytes_buffered_ -= moved;
+    src.stats_.on_pop( moved, src.bytes_buffered_, src.capacity_, src.end_input_ );
+  }
+
+  dst.written_size_ += moved;
+  dst.bytes_buffered_ += moved;
+  if ( moved > 0 ) {
+    dst.stats_.on_write( moved, dst.bytes_buffered_, dst.capacity_ );
+  }
+  dst.spill_cold_bytes();
+  return moved;
+}
+
+void ByteStream::ByteStreamImpl::spill_cold_bytes()
+{
+  if ( memory_limit_ == 0 || bytes_buffered_ <= memory_limit_ ) {
+    return;
+  }
+
+  // 读端附近和写端附近各保留memory_limit_/2常驻，中间部分换出到文件
+  const uint64_t hot = memory_limit_ / 2;
+  const uint64_t begin = max( evicted_until_, read_size_ + hot );
+  const uint64_t end = written_size_ - hot;
+
+  // 攒够一定量再换出，避免每次push都产生系统调用
+  if ( end > begin && end - begin >= hot / 2 ) {
+    evicted_until_ = ring_->evict( begin, end - begin );
+  }
+}
+
+void ByteStream::ByteStreamImpl::discard_popped_bytes()
+{
+  if ( memory_limit_ == 0 ) {
+    return;
+  }
+
+  // 只能释放物理位置尚未被写端重新使用的部分（写端位置减去环大小之前的都已被覆盖）
+  const uint64_t size = ring_->size();
+  const uint64_t begin = max( discarded_until_, written_size_ > size ? written_size_ - size : 0 );
+  if ( read_size_ > begin && read_size_ - begin >= memory_limit_ / 4 ) {
+    discarded_until_ = ring_->discard( begin, read_size_ - begin );
+  }
+}
+
+string ByteStream::ByteStreamImpl::new_block()
+{
+  if ( auto block = ChunkPool::take() ) {
+    return std::move( *block );
+  }
+
+  stats_.on_allocation();
+  string block;
+  block.reserve( ChunkPool::BLOCK_SIZE );
+  return block;
+}
+
+void ByteStream::ByteStreamImpl::release_reserved_blocks()
+{
+  for ( auto& block : reserved_blocks_ ) {
+    ChunkPool::give( std::move( block ) );
+  }
+  reserved_blocks_.clear();
+}
+
+void ByteStream::ByteStreamImpl::append_small( string_view data )
+{
+  // 尾块剩余容量足够时直接追加：不会重新分配，已交给Reader的视图依然有效
+  if ( !buffer_.empty() && buffer_.back().capacity() - buffer_.back().size() >= data.size() ) {
+    buffer_.back().append( data );
+    return;
+  }
+
+  buffer_.push_back( new_block() );
+  buffer_.back().append( data );
+}
@@ -6,6 +6,13 @@
 
 #include <deque>
 #include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "byte_stream_stats.hh"
+#include "chunk_pool.hh"
+#include "ring_buffer.hh"
 
 class Reader;
 class Writer;
@@ -13,7 +20,22 @@ class Writer;
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the buffered bytes are stored:
+  //   Chunked: a queue of the pushed strings (push moves the string in, peek sees one chunk at a time)
+  //   Ring:    one fixed-capacity ring allocated at construction (push copies, peek sees everything buffered)
+  //   Spill:   a Ring backed by a temporary file; once more than `memory_limit` bytes are buffered, the
+  //            cold middle of the buffer is evicted to the file and only the head and tail stay resident
+  //
+  // In Chunked mode, pushes shorter than SMALL_WRITE_SIZE are copied into pooled blocks (see ChunkPool),
+  // filling the free space of the last block before taking a new one; longer pushes are moved in whole.
+  enum class Storage : uint8_t
+  {
+    Chunked,
+    Ring,
+    Spill,
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Chunked, uint64_t memory_limit = 0 );
   ByteStream( const ByteStream& other );
   ByteStream( ByteStream&& other ) noexcept = default;
   ~ByteStream() = default;
@@ -29,6 +51,14 @@ public:
   void set_error() { impl_->error_ = true; };       // Signal that the stream suffered an error.
   bool has_error() const { return impl_->error_; }; // Has the stream had an error?
 
+  // Usage statistics for the stream (all zero unless built with MINNOW_STREAM_STATS)
+  ByteStreamStats stats() const { return impl_->stats_.stats(); }
+
+  friend uint64_t splice( Reader& from, Writer& to, uint64_t max_len );
+
+  static constexpr uint64_t SMALL_WRITE_SIZE = ChunkPool::BLOCK_SIZE / 4;
+  static constexpr uint64_t MAX_RESERVED_BLOCKS = 16; // Most pooled blocks one Chunked-mode reserve() hands out
+
 protected:
   // 共享状态模式，所有状态被打包进一个结构体
   struct ByteStreamImpl
@@ -47,7 +77,41 @@ protected:
     uint64_t front_offset_ { 0 };   // 记录首个分块的读取偏移量
     uint64_t bytes_buffered_ { 0 }; // 记录当前buffer里的字节总数(string作为分块掩盖了size)
 
-    explicit ByteStreamImpl( uint64_t _capacity ) : capacity_( _capacity ), buffer_() {}
+    // Ring模式：构造时一次性分配，读写位置分别为 read_size_ / written_size_ 对环大小取模
+    std::optional<RingBuffer> ring_ {};
+
+    // Spill模式：环由临时文件支撑，memory_limit_为常驻内存的目标上限（0表示不换出）
+    uint64_t memory_limit_ { 0 };
+    uint64_t evicted_until_ { 0 };   // 此位置之前的冷数据页已换出到文件
+    uint64_t discarded_until_ { 0 }; // 此位置之前已读取的页已从文件中释放
+
+    // reserve()交出但尚未commit()的可写空间大小；Chunked模式下这部分空间是若干池化的块，commit时才挂到deque尾部
+    uint64_t reserved_ { 0 };
+    std::vector<std::string> reserved_blocks_ {};
+
+    // 统计信息：未开启时为空类型，不占空间
+    [[no_unique_address]] ByteStreamStatsRecorder<ByteStreamStats::enabled> stats_ {};
+
+    ByteStreamImpl( uint64_t _capacity, Storage storage, uint64_t memory_limit )
+      : capacity_( _capacity ), buffer_()
+    {
+      if ( storage == Storage::Ring ) {
+        ring_.emplace( _capacity );
+      } else if ( storage == Storage::Spill ) {
+        ring_.emplace( _capacity, RingBuffer::Backing::TempFile );
+        memory_limit_ = memory_limit;
+      }
+      if ( ring_ ) {
+        stats_.on_allocation();
+      }
+    }
+
+    void spill_cold_bytes();     // 写入后调用：换出头尾之间的冷数据
+    void discard_popped_bytes(); // 读取后调用：释放已读数据占用的页
+
+    std::string new_block();                  // 从线程本地池中取一个空块，池空时新分配
+    void append_small( std::string_view data ); // Chunked模式：小写入追加到尾块的空闲空间
+    void release_reserved_blocks();           // 把未提交的预留块归还给池
   };
 
   std::shared_ptr<ByteStreamImpl> impl_;
@@ -59,6 +123,13 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  // Reserve up to `len` bytes of writable space inside the stream's own storage (replacing the contents of
+  // `out`), limited by available capacity (and in Chunked mode to MAX_RESERVED_BLOCKS pooled blocks). Fill a
+  // prefix of the spans, then commit() the number of bytes written. The spans stay valid until the next
+  // push(), reserve() or commit().
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len ); // Make the first `len` reserved bytes visible to the Reader.
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -70,6 +141,10 @@ public:
   std::string_view peek() const; // Peek at the next bytes in the buffer -- ideally as many as possible.
   void pop( uint64_t len );      // Remove `len` bytes from the buffer.
 
+  // Peek at up to `max_len` buffered bytes as a list of contiguous views (replacing the contents of `out`).
+  // The list can be handed directly to FileDescriptor::write, followed by pop() of the bytes written.
+  void peek( uint64_t max_len, std::vector<std::string_view>& out ) const;
+
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
@@ -80,3 +155,25 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t max_len, std::string& out );
+
+constexpr uint64_t RECORD_HEADER_SIZE = 4;
+
+/*
+ * peek_record: frames a length-prefixed record (a RECORD_HEADER_SIZE-byte big-endian payload
+ * length, then the payload) at the front of a Reader without popping anything.
+ *
+ * If the whole record is buffered, returns its payload: a view straight into the stream when
+ * the record is contiguous there, otherwise a view of `scratch`, into which it was assembled.
+ * Either view is valid until the Reader or `scratch` changes; afterwards the caller should
+ * pop( RECORD_HEADER_SIZE + payload.size() ). If the record is incomplete, returns nullopt.
+ * In both cases `bytes_needed` is set to how many more bytes must arrive to complete it.
+ */
+std::optional<std::string_view> peek_record( const Reader& reader, std::string& scratch, uint64_t& bytes_needed );
+
+/*
+ * splice: moves up to `max_len` bytes from a Reader to another stream's Writer, limited by the
+ * destination's available capacity, and returns the number of bytes moved. Between chunked
+ * streams, whole buffered chunks change owner and only a partially-consumed or partially-moved
+ * chunk is copied; ring storage on either side costs a single copy with no intermediate string.
+ */
+uint64_t splice( Reader& from, Writer& to, uint64_t max_len );
@@ -1,7 +1,11 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <optional>
 #include <stdexcept>
+#include <vector>
 
 using namespace std;
 
@@ -26,6 +30,68 @@ void read( Reader& reader, uint64_t max_len, string& out )
   }
 }
 
+namespace {
+// Copy `len` bytes starting `offset` bytes into a list of views
+void copy_from_views( const vector<string_view>& views, uint64_t offset, uint64_t len, char* dst )
+{
+  for ( const auto& view : views ) {
+    if ( len == 0 ) {
+      break;
+    }
+    if ( offset >= view.size() ) {
+      offset -= view.size();
+      continue;
+    }
+    const auto piece = view.substr( offset, len );
+    dst = copy( piece.begin(), piece.end(), dst );
+    len -= piece.size();
+    offset = 0;
+  }
+}
+} // namespace
+
+optional<string_view> peek_record( const Reader& reader, string& scratch, uint64_t& bytes_needed )
+{
+  const uint64_t buffered = reader.bytes_buffered();
+  if ( buffered < RECORD_HEADER_SIZE ) {
+    bytes_needed = RECORD_HEADER_SIZE - buffered;
+    return nullopt;
+  }
+
+  // Parse the header from the first chunk when possible, otherwise gather it from the views.
+  thread_local vector<string_view> views;
+  const string_view front = reader.peek();
+  array<char, RECORD_HEADER_SIZE> header {};
+  if ( front.size() >= RECORD_HEADER_SIZE ) {
+    copy( front.begin(), front.begin() + RECORD_HEADER_SIZE, header.begin() );
+  } else {
+    reader.peek( RECORD_HEADER_SIZE, views );
+    copy_from_views( views, 0, RECORD_HEADER_SIZE, header.data() );
+  }
+
+  uint64_t payload_len = 0;
+  for ( const char c : header ) {
+    payload_len = ( payload_len << 8 ) | static_cast<uint8_t>( c );
+  }
+
+  const uint64_t record_len = RECORD_HEADER_SIZE + payload_len;
+  if ( buffered < record_len ) {
+    bytes_needed = record_len - buffered;
+    return nullopt;
+  }
+  bytes_needed = 0;
+
+  if ( front.size() >= record_len ) {
+    return front.substr( RECORD_HEADER_SIZE, payload_len );
+  }
+
+  // The record spans chunks: assemble the payload into the caller's buffer.
+  reader.peek( record_len, views );
+  scratch.resize( payload_len );
+  copy_from_views( views, RECORD_HEADER_SIZE, payload_len, scratch.data() );
+  return scratch;
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
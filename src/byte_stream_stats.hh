@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+// Build with -DMINNOW_STREAM_STATS=1 (cmake -DMINNOW_STREAM_STATS=ON) to record ByteStream statistics.
+#ifndef MINNOW_STREAM_STATS
+#define MINNOW_STREAM_STATS 0
+#endif
+
+/*
+ * ByteStreamStats: counters describing how a ByteStream has been used.
+ *
+ * A stream that spends its time full is limited by its reader; one that spends its time empty
+ * (while still open) is limited by its writer. When statistics are compiled out, every field
+ * stays zero.
+ */
+struct ByteStreamStats
+{
+  static constexpr bool enabled = MINNOW_STREAM_STATS;
+
+  uint64_t peak_bytes_buffered {};        // Most bytes ever buffered at once
+  std::chrono::nanoseconds time_full {};  // Time spent with zero available capacity
+  std::chrono::nanoseconds time_empty {}; // Time spent open with nothing buffered
+  uint64_t chunks {};                     // Number of non-empty writes (push, commit or splice)
+  uint64_t chunk_bytes {};                // Total bytes carried by those writes
+  uint64_t allocations {};                // Buffers allocated or adopted to hold the stream's bytes
+
+  double mean_chunk_size() const { return chunks ? static_cast<double>( chunk_bytes ) / chunks : 0; }
+};
+
+// Records ByteStreamStats for a stream; the disabled specialization is empty and every hook is a no-op.
+template<bool Enabled>
+class ByteStreamStatsRecorder
+{
+public:
+  void on_write( uint64_t /* len */, uint64_t /* buffered */, uint64_t /* capacity */ ) {}
+  void on_pop( uint64_t /* len */, uint64_t /* buffered */, uint64_t /* capacity */, bool /* closed */ ) {}
+  void on_close() {}
+  void on_allocation() {}
+  ByteStreamStats stats() const { return {}; }
+};
+
+template<>
+class ByteStreamStatsRecorder<true>
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // 写入后调用：buffered为写入后的缓存量
+  void on_write( uint64_t len, uint64_t buffered, uint64_t capacity )
+  {
+    stats_.chunks++;
+    stats_.chunk_bytes += len;
+    stats_.peak_bytes_buffered = std::max( stats_.peak_bytes_buffered, buffered );
+
+    // 只在状态切换时读取时钟
+    if ( buffered == len ) {
+      end_interval( empty_since_, stats_.time_empty );
+    }
+    if ( buffered == capacity ) {
+      full_since_ = Clock::now();
+    }
+  }
+
+  // 读取后调用：buffered为读取后的缓存量
+  void on_pop( uint64_t len, uint64_t buffered, uint64_t capacity, bool closed )
+  {
+    if ( len == 0 ) {
+      return;
+    }
+    if ( buffered + len == capacity ) {
+      end_interval( full_since_, stats_.time_full );
+    }
+    if ( buffered == 0 && !closed ) {
+      empty_since_ = Clock::now();
+    }
+  }
+
+  // 关闭后读端不再等待数据
+  void on_close() { end_interval( empty_since_, stats_.time_empty ); }
+
+  void on_allocation() { stats_.allocations++; }
+
+  // 尚未结束的满/空区间也计入结果
+  ByteStreamStats stats() const
+  {
+    ByteStreamStats ret = stats_;
+    const auto now = Clock::now();
+    if ( full_since_ ) {
+      ret.time_full += now - *full_since_;
+    }
+    if ( empty_since_ ) {
+      ret.time_empty += now - *empty_since_;
+    }
+    return ret;
+  }
+
+private:
+  ByteStreamStats stats_ {};
+  std::optional<Clock::time_point> full_since_ {};
+  std::optional<Clock::time_point> empty_since_ { Clock::now() }; // 新建的流为空，读端等待第一个字节
+
+  static void end_interval( std::optional<Clock::time_point>& since, std::chrono::nanoseconds& total )
+  {
+    if ( since ) {
+      total += Clock::now() - *since;
+      since.reset();
+    }
+  }
+};
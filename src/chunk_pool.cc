@@ -0,0 +1,39 @@
+#include "chunk_pool.hh"
+
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+// 每个线程独立的空闲块列表，无需加锁
+vector<string>& free_blocks()
+{
+  thread_local vector<string> blocks;
+  return blocks;
+}
+} // namespace
+
+optional<string> ChunkPool::take()
+{
+  auto& blocks = free_blocks();
+  if ( blocks.empty() ) {
+    return nullopt;
+  }
+
+  string block = move( blocks.back() );
+  blocks.pop_back();
+  return block;
+}
+
+void ChunkPool::give( string&& block )
+{
+  auto& blocks = free_blocks();
+  // 只回收标准大小的块，避免大块长期占用内存
+  if ( !is_block( block ) || blocks.size() >= MAX_FREE_BLOCKS ) {
+    return;
+  }
+
+  block.clear();
+  blocks.push_back( move( block ) );
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+/*
+ * ChunkPool: a per-thread free list of fixed-size string blocks for chunked ByteStreams.
+ *
+ * Small writes are copied into BLOCK_SIZE blocks instead of each becoming its own string,
+ * and blocks that the reader has finished with are returned here to be reused by the next
+ * write on the same thread. A block released on another thread simply joins that thread's
+ * pool. Each thread keeps at most MAX_FREE_BLOCKS idle blocks.
+ */
+class ChunkPool
+{
+public:
+  static constexpr size_t BLOCK_SIZE = 4096;
+  static constexpr size_t MAX_FREE_BLOCKS = 256;
+
+  // An empty block with capacity of at least BLOCK_SIZE, if one is free on this thread
+  static std::optional<std::string> take();
+
+  // Return a block for reuse (ignored unless it is a pool-sized block and the pool has room)
+  static void give( std::string&& block );
+
+  // Could `block` have come from reserve(BLOCK_SIZE)? The library may round the capacity up, so allow slack.
+  static bool is_block( const std::string& block )
+  {
+    return block.capacity() >= BLOCK_SIZE && block.capacity() <= 2 * BLOCK_SIZE;
+  }
+};
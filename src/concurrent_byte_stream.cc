@@ -0,0 +1,217 @@
+#include "concurrent_byte_stream.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+ConcurrentByteStream::ConcurrentByteStreamImpl::ConcurrentByteStreamImpl( uint64_t capacity, bool wakeups )
+  : capacity_( capacity ), ring_( capacity )
+{
+  if ( wakeups ) {
+    readable_.emplace();
+    writable_.emplace();
+  }
+}
+
+ConcurrentByteStream::ConcurrentByteStream( uint64_t capacity, bool wakeups )
+  : impl_( make_unique<ConcurrentByteStreamImpl>( capacity, wakeups ) )
+{}
+
+ConcurrentReader& ConcurrentByteStream::reader()
+{
+  static_assert( sizeof( ConcurrentReader ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base." );
+
+  return static_cast<ConcurrentReader&>( *this ); // NOLINT(*-downcast)
+}
+
+const ConcurrentReader& ConcurrentByteStream::reader() const
+{
+  return static_cast<const ConcurrentReader&>( *this ); // NOLINT(*-downcast)
+}
+
+ConcurrentWriter& ConcurrentByteStream::writer()
+{
+  static_assert( sizeof( ConcurrentWriter ) == sizeof( ConcurrentByteStream ),
+                 "Please add member variables to the ConcurrentByteStream base." );
+
+  return static_cast<ConcurrentWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const ConcurrentWriter& ConcurrentByteStream::writer() const
+{
+  return static_cast<const ConcurrentWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+void ConcurrentByteStream::set_error()
+{
+  impl_->error_.store( true, memory_order_release );
+  if ( impl_->readable_ ) {
+    impl_->readable_->notify();
+    impl_->writable_->notify();
+  }
+}
+
+bool ConcurrentByteStream::has_error() const
+{
+  return impl_->error_.load( memory_order_acquire );
+}
+
+EventFD& ConcurrentByteStream::readable_event()
+{
+  if ( !impl_->readable_ ) {
+    throw runtime_error( "ConcurrentByteStream was constructed without wakeups" );
+  }
+  return *impl_->readable_;
+}
+
+EventFD& ConcurrentByteStream::writable_event()
+{
+  if ( !impl_->writable_ ) {
+    throw runtime_error( "ConcurrentByteStream was constructed without wakeups" );
+  }
+  return *impl_->writable_;
+}
+
+void ConcurrentWriter::push( string_view data )
+{
+  impl_->reserved_ = 0;
+
+  if ( data.empty() || is_closed() ) {
+    return;
+  }
+
+  const uint64_t len = min( available_capacity(), static_cast<uint64_t>( data.size() ) );
+  if ( len == 0 ) {
+    return;
+  }
+
+  // 先写入数据，再通过release发布新的pushed_，读端acquire后即可看到完整数据
+  impl_->ring_.write( impl_->pushed_.load( memory_order_relaxed ), data.substr( 0, len ) );
+  publish( len );
+}
+
+void ConcurrentWriter::reserve( uint64_t len, vector<span<char>>& out )
+{
+  out.clear();
+  impl_->reserved_ = 0;
+
+  if ( is_closed() ) {
+    return;
+  }
+
+  uint64_t remaining = min( len, available_capacity() );
+  impl_->reserved_ = remaining;
+
+  uint64_t pos = impl_->pushed_.load( memory_order_relaxed );
+  while ( remaining > 0 ) {
+    const span<char> region = impl_->ring_.span( pos, remaining );
+    out.push_back( region );
+    pos += region.size();
+    remaining -= region.size();
+  }
+}
+
+void ConcurrentWriter::commit( uint64_t len )
+{
+  if ( len > impl_->reserved_ ) {
+    throw runtime_error( "ConcurrentWriter::commit() called with more bytes than were reserved" );
+  }
+  impl_->reserved_ = 0;
+
+  if ( len > 0 ) {
+    publish( len );
+  }
+}
+
+void ConcurrentWriter::publish( uint64_t len )
+{
+  const uint64_t old_pushed = impl_->pushed_.load( memory_order_relaxed );
+  impl_->pushed_.store( old_pushed + len, memory_order_release );
+
+  if ( impl_->readable_ ) {
+    // 与读端pop中的fence配对（Dekker式）：要么这里看到读端已读空，要么读端之后能看到新数据
+    atomic_thread_fence( memory_order_seq_cst );
+    if ( impl_->popped_.load( memory_order_relaxed ) == old_pushed ) {
+      impl_->readable_->notify();
+    }
+  }
+}
+
+void ConcurrentWriter::close()
+{
+  impl_->closed_.store( true, memory_order_release );
+  if ( impl_->readable_ ) {
+    impl_->readable_->notify();
+  }
+}
+
+bool ConcurrentWriter::is_closed() const
+{
+  return impl_->closed_.load( memory_order_acquire );
+}
+
+uint64_t ConcurrentWriter::available_capacity() const
+{
+  const uint64_t popped = impl_->popped_.load( memory_order_acquire );
+  return impl_->capacity_ - ( impl_->pushed_.load( memory_order_relaxed ) - popped );
+}
+
+uint64_t ConcurrentWriter::bytes_pushed() const
+{
+  return impl_->pushed_.load( memory_order_relaxed );
+}
+
+string_view ConcurrentReader::peek() const
+{
+  return impl_->ring_.view( impl_->popped_.load( memory_order_relaxed ), bytes_buffered() );
+}
+
+void ConcurrentReader::peek( uint64_t max_len, vector<string_view>& out ) const
+{
+  out.clear();
+  uint64_t remaining = min( max_len, bytes_buffered() );
+  uint64_t pos = impl_->popped_.load( memory_order_relaxed );
+  while ( remaining > 0 ) {
+    const string_view view = impl_->ring_.view( pos, remaining );
+    out.push_back( view );
+    pos += view.size();
+    remaining -= view.size();
+  }
+}
+
+void ConcurrentReader::pop( uint64_t len )
+{
+  len = min( len, bytes_buffered() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  // release保证读端对这段空间的读取先于写端重新写入
+  const uint64_t old_popped = impl_->popped_.load( memory_order_relaxed );
+  impl_->popped_.store( old_popped + len, memory_order_release );
+
+  if ( impl_->writable_ ) {
+    atomic_thread_fence( memory_order_seq_cst );
+    if ( impl_->pushed_.load( memory_order_relaxed ) - old_popped == impl_->capacity_ ) {
+      impl_->writable_->notify();
+    }
+  }
+}
+
+bool ConcurrentReader::is_finished() const
+{
+  // 先读closed_：写端close前的所有push都已对本线程可见
+  return impl_->closed_.load( memory_order_acquire ) && bytes_buffered() == 0;
+}
+
+uint64_t ConcurrentReader::bytes_buffered() const
+{
+  return impl_->pushed_.load( memory_order_acquire ) - impl_->popped_.load( memory_order_relaxed );
+}
+
+uint64_t ConcurrentReader::bytes_popped() const
+{
+  return impl_->popped_.load( memory_order_relaxed );
+}
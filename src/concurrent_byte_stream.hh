@@ -0,0 +1,108 @@
+#pragma once
+
+#include "eventfd.hh"
+#include "ring_buffer.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+class ConcurrentReader;
+class ConcurrentWriter;
+
+/*
+ * ConcurrentByteStream: a ByteStream shared by exactly one writer thread and one reader thread.
+ *
+ * It offers the same Reader/Writer surface as ByteStream, built as a lock-free
+ * single-producer/single-consumer ring. The writer only advances the pushed counter and the
+ * reader only advances the popped counter; each counter lives on its own cache line, is
+ * published with release and observed with acquire. Writer methods may only be called from
+ * the writer thread and Reader methods only from the reader thread.
+ *
+ * With wakeups enabled, the writer makes readable_event() readable when it pushes into a
+ * stream the reader has drained (or closes it), and the reader makes writable_event()
+ * readable when it pops from a full stream, so either side can sleep in an EventLoop.
+ * A woken side should clear() the event before consuming, then consume until it runs dry.
+ *
+ * TCPMinnowSocket does not use it yet: its owner-facing API is a file descriptor, so the
+ * app <-> TCP-thread path still goes through a socketpair.
+ */
+class ConcurrentByteStream
+{
+public:
+  explicit ConcurrentByteStream( uint64_t capacity, bool wakeups = false );
+
+  // Helper functions to access the ConcurrentByteStream's Reader and Writer interfaces
+  ConcurrentReader& reader();
+  const ConcurrentReader& reader() const;
+  ConcurrentWriter& writer();
+  const ConcurrentWriter& writer() const;
+
+  void set_error();       // Signal that the stream suffered an error (from either thread).
+  bool has_error() const; // Has the stream had an error?
+
+  // Wakeup descriptors, for use in an EventLoop (only available if constructed with wakeups)
+  EventFD& readable_event();
+  EventFD& writable_event();
+
+protected:
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  struct ConcurrentByteStreamImpl
+  {
+    uint64_t capacity_;
+    RingBuffer ring_;
+    std::optional<EventFD> readable_ {};
+    std::optional<EventFD> writable_ {};
+
+    // 写端独占的缓存行：只有写线程修改pushed_与预留状态
+    alignas( CACHE_LINE_SIZE ) std::atomic<uint64_t> pushed_ { 0 };
+    uint64_t reserved_ { 0 };
+
+    // 读端独占的缓存行：只有读线程修改popped_
+    alignas( CACHE_LINE_SIZE ) std::atomic<uint64_t> popped_ { 0 };
+
+    // 很少变化的状态标志
+    alignas( CACHE_LINE_SIZE ) std::atomic<bool> closed_ { false };
+    std::atomic<bool> error_ { false };
+
+    ConcurrentByteStreamImpl( uint64_t capacity, bool wakeups );
+  };
+
+  std::unique_ptr<ConcurrentByteStreamImpl> impl_;
+};
+
+class ConcurrentWriter : public ConcurrentByteStream
+{
+public:
+  void push( std::string_view data ); // Copy data into the stream, but only as much as available capacity allows.
+  void close();                       // Signal that nothing more will be written.
+
+  // Reserve writable space inside the ring and publish a prefix of it (see Writer::reserve/commit)
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len );
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+private:
+  void publish( uint64_t len );
+};
+
+class ConcurrentReader : public ConcurrentByteStream
+{
+public:
+  std::string_view peek() const; // Peek at the next bytes in the buffer (everything, if the ring is mirrored)
+  void peek( uint64_t max_len, std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len ); // Remove `len` bytes from the buffer.
+
+  bool is_finished() const;        // Is the stream finished (closed and fully popped)?
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+};
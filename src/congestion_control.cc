@@ -0,0 +1,166 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionControl> CongestionControl::make( Algorithm algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case Algorithm::NewReno:
+      return make_unique<NewReno>( mss );
+    case Algorithm::Cubic:
+      return make_unique<Cubic>( mss );
+    case Algorithm::None:
+      break;
+  }
+  return nullptr;
+}
+
+CongestionControl::CongestionControl( uint64_t mss ) : mss_( mss ), cwnd_( initial_window() ) {}
+
+uint64_t CongestionControl::initial_window() const
+{
+  // RFC 6928：min(10*MSS, max(2*MSS, 14600))
+  return min( 10 * mss_, max( 2 * mss_, uint64_t { 14600 } ) );
+}
+
+uint64_t CongestionControl::slow_start( uint64_t bytes_acked )
+{
+  // 每个ACK最多增长一个MSS，越过ssthresh后剩余部分交给拥塞避免
+  const uint64_t growth = min( { bytes_acked, mss_, ssthresh_ - cwnd_ } );
+  cwnd_ += growth;
+  return in_slow_start() ? 0 : bytes_acked - growth;
+}
+
+void CongestionControl::set_mss( uint64_t mss )
+{
+  // 窗口尚未变化（连接刚建立时协商出MSS）时，按新的MSS重新计算初始窗口
+  const bool initial = cwnd_ == initial_window() && ssthresh_ == UINT64_MAX;
+  mss_ = mss;
+  if ( initial ) {
+    cwnd_ = initial_window();
+  }
+}
+
+void CongestionControl::save_undo_state()
+{
+  prior_cwnd_ = cwnd_;
+  prior_ssthresh_ = ssthresh_;
+}
+
+void CongestionControl::undo()
+{
+  // 恢复到丢包前的状态，期间已有的增长保留
+  cwnd_ = max( cwnd_, prior_cwnd_ );
+  ssthresh_ = max( ssthresh_, prior_ssthresh_ );
+}
+
+void NewReno::on_ack( uint64_t bytes_acked, uint64_t /* now_ms */ )
+{
+  if ( in_slow_start() ) {
+    bytes_acked = slow_start( bytes_acked );
+  }
+
+  // 拥塞避免：每确认一整个窗口的数据，cwnd增加一个MSS
+  bytes_acked_ += bytes_acked;
+  while ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t bytes_in_flight, uint64_t /* now_ms */ )
+{
+  ssthresh_ = max( bytes_in_flight / 2, min_ssthresh() );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_rto( uint64_t bytes_in_flight, uint64_t /* now_ms */ )
+{
+  // 超时后从一个MSS重新慢启动
+  ssthresh_ = max( bytes_in_flight / 2, min_ssthresh() );
+  cwnd_ = mss_;
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_ack( uint64_t bytes_acked, uint64_t now_ms )
+{
+  if ( in_slow_start() ) {
+    bytes_acked = slow_start( bytes_acked );
+    if ( bytes_acked == 0 ) {
+      return;
+    }
+  }
+
+  const double mss = static_cast<double>( mss_ );
+  const double cwnd = static_cast<double>( cwnd_ ) / mss;
+
+  // 新的拥塞避免阶段：以上次丢包前的窗口为平台，计算回到平台所需时间K
+  if ( !epoch_started_ ) {
+    epoch_started_ = true;
+    epoch_start_ = now_ms;
+    if ( cwnd < w_max_ ) {
+      k_ = cbrt( ( w_max_ - cwnd ) / C );
+      origin_ = w_max_;
+    } else {
+      k_ = 0;
+      origin_ = cwnd;
+    }
+    w_est_ = cwnd;
+  }
+
+  // W_cubic(t) = C * (t - K)^3 + W_max，目标值限制在 [cwnd, 1.5 * cwnd]
+  const double t = static_cast<double>( now_ms - epoch_start_ ) / 1000;
+  const double target = clamp( origin_ + C * pow( t - k_, 3 ), cwnd, 1.5 * cwnd );
+  const double segments_acked = static_cast<double>( bytes_acked ) / mss;
+  double growth = ( target - cwnd ) / cwnd * segments_acked;
+
+  // 与Reno公平：增长不慢于同等条件下的Reno
+  constexpr double alpha = 3 * ( 1 - BETA ) / ( 1 + BETA );
+  w_est_ += alpha * segments_acked / cwnd;
+  growth = max( growth, w_est_ - cwnd );
+
+  cwnd_frac_ += growth * mss;
+  const double whole = floor( cwnd_frac_ );
+  cwnd_ += static_cast<uint64_t>( whole );
+  cwnd_frac_ -= whole;
+}
+
+void Cubic::reduce()
+{
+  // 快速收敛：窗口仍低于上次的平台时，进一步让出带宽
+  const double cwnd = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+  w_max_ = cwnd < w_max_ ? cwnd * ( 1 + BETA ) / 2 : cwnd;
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), min_ssthresh() );
+  epoch_started_ = false;
+  cwnd_frac_ = 0;
+}
+
+void Cubic::on_loss( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ )
+{
+  reduce();
+  cwnd_ = ssthresh_;
+}
+
+void Cubic::on_rto( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ )
+{
+  reduce();
+  cwnd_ = mss_;
+}
+
+void Cubic::save_undo_state()
+{
+  CongestionControl::save_undo_state();
+  prior_w_max_ = w_max_;
+}
+
+void Cubic::undo()
+{
+  CongestionControl::undo();
+  w_max_ = prior_w_max_;
+  epoch_started_ = false;
+  cwnd_frac_ = 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "tcp_config.hh"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/*
+ * CongestionControl: the congestion window policy of a TCPSender.
+ *
+ * The sender reports every transmission, every cumulative acknowledgment, and every loss it
+ * detects (by duplicate acknowledgments or SACK, or by the retransmission timer expiring),
+ * and limits the sequence numbers in flight to the smaller of the peer's window and cwnd().
+ * All sizes are in sequence numbers; times are milliseconds on the sender's tick() clock.
+ */
+class CongestionControl
+{
+public:
+  using Algorithm = CongestionControlAlgorithm;
+
+  // The chosen algorithm, or nullptr for Algorithm::None (no congestion window at all)
+  static std::unique_ptr<CongestionControl> make( Algorithm algorithm, uint64_t mss );
+
+  explicit CongestionControl( uint64_t mss );
+  virtual ~CongestionControl() = default;
+
+  CongestionControl( const CongestionControl& ) = delete;
+  CongestionControl& operator=( const CongestionControl& ) = delete;
+  CongestionControl( CongestionControl&& ) = delete;
+  CongestionControl& operator=( CongestionControl&& ) = delete;
+
+  virtual std::string_view name() const = 0;
+
+  // `bytes` new sequence numbers were sent
+  virtual void on_send( uint64_t /* bytes */, uint64_t /* now_ms */ ) {}
+
+  // The cumulative ackno advanced by `bytes_acked`
+  virtual void on_ack( uint64_t bytes_acked, uint64_t now_ms ) = 0;
+
+  // A loss was inferred while `bytes_in_flight` were outstanding (once per window of data)
+  virtual void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // The retransmission timer expired while `bytes_in_flight` were outstanding
+  virtual void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // The sender's MSS changed (negotiated on the SYN, or found by path MTU discovery)
+  virtual void set_mss( uint64_t mss );
+
+  // Remember the current state before the first reduction of a loss episode...
+  virtual void save_undo_state();
+  // ... and return to it if every retransmission of the episode proves spurious
+  virtual void undo();
+
+  uint64_t mss() const { return mss_; }
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t ssthresh() const { return ssthresh_; }
+  bool in_slow_start() const { return cwnd_ < ssthresh_; }
+
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { UINT64_MAX };
+  uint64_t prior_cwnd_ {};
+  uint64_t prior_ssthresh_ { UINT64_MAX };
+
+  // Initial window (RFC 6928) and the floor of ssthresh after a loss (RFC 5681)
+  uint64_t initial_window() const;
+  uint64_t min_ssthresh() const { return 2 * mss_; }
+
+  // Slow start: grow by at most one MSS per acknowledgment; returns the acked bytes left over
+  uint64_t slow_start( uint64_t bytes_acked );
+};
+
+// RFC 5681/6582: slow start, then one MSS of growth per window of acknowledged data; halve on loss.
+class NewReno : public CongestionControl
+{
+public:
+  using CongestionControl::CongestionControl;
+
+  std::string_view name() const override { return "NewReno"; }
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+
+private:
+  uint64_t bytes_acked_ {}; // Acknowledged bytes not yet turned into congestion-avoidance growth
+};
+
+// RFC 9438: the window grows as a cubic function of the time since the last reduction, centred on
+// the window at which that loss happened, and never more slowly than Reno would.
+class Cubic : public CongestionControl
+{
+public:
+  using CongestionControl::CongestionControl;
+
+  static constexpr double C = 0.4;    // Scaling constant, in MSS per second cubed
+  static constexpr double BETA = 0.7; // Multiplicative decrease factor
+
+  std::string_view name() const override { return "CUBIC"; }
+
+  void on_ack( uint64_t bytes_acked, uint64_t now_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void save_undo_state() override;
+  void undo() override;
+
+private:
+  bool epoch_started_ {};   // Whether the current congestion-avoidance epoch has begun
+  uint64_t epoch_start_ {}; // When it began
+  double w_max_ {};         // Window (in MSS) just before the last reduction
+  double k_ {};             // Seconds the cubic takes to climb back to its origin
+  double origin_ {};        // Window (in MSS) at the cubic's plateau
+  double w_est_ {};         // Reno-friendly estimate (in MSS)
+  double cwnd_frac_ {};     // Fractional bytes of growth not yet added to cwnd_
+  double prior_w_max_ {};   // w_max_ saved for undo
+
+  void reduce();
+};
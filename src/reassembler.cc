@@ -1,9 +1,45 @@
 #include "reassembler.hh"
 #include "debug.hh"
+#include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
 
 using namespace std;
 
+namespace {
+// 将环上绝对位置[begin, end)对应的位按64位字逐个交给fn（环绕处拆开），fn返回false时提前结束
+template<typename Fn>
+void for_each_bit_word( uint64_t size, uint64_t begin, uint64_t end, const Fn& fn )
+{
+  while ( begin < end ) {
+    const uint64_t offset = begin % size;
+    const uint64_t len = min( { end - begin, size - offset, 64 - offset % 64 } );
+    const uint64_t mask = ( len == 64 ? ~uint64_t { 0 } : ( uint64_t { 1 } << len ) - 1 ) << ( offset % 64 );
+    if ( !fn( offset / 64, mask ) ) {
+      return;
+    }
+    begin += len;
+  }
+}
+} // namespace
+
+Reassembler::Reassembler( ByteStream&& output, Engine engine, ReassemblerLimits limits )
+  : output_( std::move( output ) )
+  , str_buffer_()
+  , max_fragments_( limits.max_fragments )
+  , max_metadata_bytes_( limits.max_metadata_bytes )
+{
+  if ( engine == Engine::Ring ) {
+    // 待重组字节总在[cur_index_, cur_index_ + capacity)内，环不小于capacity即可保证不重叠
+    const uint64_t capacity = output_.writer().available_capacity() + output_.reader().bytes_buffered();
+    pending_ring_.emplace( capacity );
+    present_.resize( ( pending_ring_->size() + 63 ) / 64 );
+  }
+}
+
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
 {
   debug( "insert func was called: arg: first_index: {}, data: {}, is_last_substring: {}",
@@ -18,6 +54,14 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
     have_got_end_index_ = true;
   }
 
+  if ( pending_ring_ ) {
+    insert_into_ring( first_index, std::move( data ) );
+    if ( have_got_end_index_ && cur_index_ >= end_index_ ) {
+      output_.writer().close();
+    }
+    return;
+  }
+
   // Part 1：裁剪两端超长部分
   // 去除已写入部分
   if ( first_index + data.size() <= cur_index_ ) {
@@ -28,17 +72,17 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
   }
   if ( first_index < cur_index_ ) {
     const uint64_t skip = cur_index_ - first_index;
-    data = data.substr( skip );
+    data.erase( 0, skip );
     first_index = cur_index_;
   }
 
-  // 去除超出容量部分
-  const uint64_t max_end = cur_index_ + output_.writer().available_capacity();
+  // 去除超出容量部分，以及流结束位置之后的部分
+  const uint64_t max_end = window_end();
   if ( first_index >= max_end ) {
     return;
   }
   if ( first_index + data.size() > max_end ) {
-    data = data.substr( 0, max_end - first_index );
+    data.resize( max_end - first_index );
   }
 
   // Part 2：尝试写入内容
@@ -60,6 +104,7 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
   } else {
     // 数据不连续，需要缓存并去重
     merge_into_buffer( first_index, data );
+    enforce_limits();
   }
 }
 
@@ -75,24 +120,25 @@ void Reassembler::drain_buffer()
       break;
     }
 
-    string& segment = it->second;
+    Fragment& segment = it->second;
     const uint64_t seg_end = seg_start + segment.size();
 
     // 整段已写过，删除
     if ( seg_end <= cur_index_ ) {
-      str_buffer_.erase( it );
+      erase_fragment( it );
       continue;
     }
 
+    fragment_slack_ -= segment.slack();
+
     // 部分重叠，截掉已写部分
     if ( seg_start < cur_index_ ) {
-      const uint64_t skip = cur_index_ - seg_start;
-      segment = segment.substr( skip );
+      segment.remove_prefix( cur_index_ - seg_start );
     }
 
     // 写入并更新位置
     cur_index_ += segment.size();
-    output_.writer().push( move( segment ) );
+    output_.writer().push( segment.release() );
     str_buffer_.erase( it );
   }
 }
@@ -108,8 +154,9 @@ void Reassembler::merge_into_buffer( uint64_t& first_index, string& data )
   auto it = str_buffer_.lower_bound( first_index );
 
   // 检查前一个片段的重叠
+  auto prev = str_buffer_.end();
   if ( it != str_buffer_.begin() ) {
-    auto prev = std::prev( it );
+    prev = std::prev( it );
     const uint64_t prev_end = prev->first + prev->second.size();
 
     if ( prev_end > first_index ) {
@@ -119,33 +166,260 @@ void Reassembler::merge_into_buffer( uint64_t& first_index, string& data )
       }
       // 截掉左侧重叠
       const uint64_t skip = prev_end - first_index;
-      data = data.substr( skip );
+      data.erase( 0, skip );
       first_index = prev_end;
       data_end = first_index + data.size();
+    } else if ( prev_end < first_index ) {
+      // 与前一个片段之间有空洞，不能合并
+      prev = str_buffer_.end();
     }
   }
 
-  // 检查后续片段的重叠
-  while ( it != str_buffer_.end() && it->first < data_end ) {
-    const uint64_t next_end = it->first + it->second.size();
+  // 检查后续片段的重叠，被完全覆盖的删除
+  while ( it != str_buffer_.end() && it->first + it->second.size() <= data_end ) {
+    it = erase_fragment( it );
+  }
+
+  // 与后一个片段重叠或相邻：截掉重叠部分
+  auto next = str_buffer_.end();
+  if ( it != str_buffer_.end() && it->first <= data_end ) {
+    data.resize( it->first - first_index );
+    next = it;
+  }
+
+  if ( data.empty() ) {
+    return;
+  }
 
-    if ( next_end <= data_end ) {
-      // 后续片段被完全覆盖，删除
-      it = str_buffer_.erase( it );
+  // 参与合并的片段先从元数据预算中扣除，合并之后再计入结果片段
+  for ( const auto& fragment : { prev, next } ) {
+    if ( fragment != str_buffer_.end() ) {
+      fragment_slack_ -= fragment->second.slack();
+    }
+  }
+
+  // 相邻的片段合并为一个节点。总是把较短的一方拷贝进较长的一方，这样每个字节只会被拷贝对数次，
+  // 逆序到达的数据段不会反复拷贝已经攒起来的长片段
+  const uint64_t prev_size = prev != str_buffer_.end() ? prev->second.size() : 0;
+  const uint64_t next_size = next != str_buffer_.end() ? next->second.size() : 0;
+  if ( prev_size + data.size() >= next_size ) {
+    // 接到前一个片段末尾（没有则新建片段），后一个片段再接在后面
+    if ( prev != str_buffer_.end() ) {
+      prev->second.append( data );
     } else {
-      // 部分覆盖，截断当前数据
-      data = data.substr( 0, it->first - first_index );
-      break;
+      prev = str_buffer_.emplace_hint( it, first_index, Fragment( move( data ) ) );
+    }
+    if ( next != str_buffer_.end() ) {
+      prev->second.append( next->second.view() );
+      str_buffer_.erase( next );
+    }
+    fragment_slack_ += prev->second.slack();
+    return;
+  }
+
+  // 后一个片段更长：把数据和前一个片段依次拼接到它前面，再修改它的起始索引
+  next->second.prepend( data, first_index - cur_index_ );
+  uint64_t start = first_index;
+  if ( prev != str_buffer_.end() ) {
+    start = prev->first;
+    next->second.prepend( prev->second.view(), start - cur_index_ );
+    str_buffer_.erase( prev );
+  }
+  fragment_slack_ += next->second.slack();
+  rekey( next, start );
+}
+
+void Reassembler::rekey( map<uint64_t, Fragment>::iterator it, uint64_t first_index )
+{
+  auto node = str_buffer_.extract( it );
+  node.key() = first_index;
+  str_buffer_.insert( std::move( node ) );
+}
+
+void Reassembler::Fragment::prepend( string_view bytes, uint64_t room )
+{
+  if ( head_ < bytes.size() ) {
+    // 按现有长度成倍预留前部空间，摊还下来每个字节的搬移是常数次
+    const uint64_t headroom = bytes.size() + min( size(), room );
+    string grown;
+    grown.reserve( headroom + size() );
+    grown.resize( headroom );
+    grown.append( view() );
+    buf_ = std::move( grown );
+    head_ = headroom;
+  }
+  head_ -= bytes.size();
+  memcpy( buf_.data() + head_, bytes.data(), bytes.size() );
+}
+
+string Reassembler::Fragment::release()
+{
+  buf_.erase( 0, head_ );
+  head_ = 0;
+  return std::move( buf_ );
+}
+
+map<uint64_t, Reassembler::Fragment>::iterator Reassembler::erase_fragment( map<uint64_t, Fragment>::iterator it )
+{
+  fragment_slack_ -= it->second.slack();
+  return str_buffer_.erase( it );
+}
+
+void Reassembler::enforce_limits()
+{
+  // 元数据：每个片段的树节点与对象开销，加上片段缓冲区中数据之外的空间（capacity而非size）
+  // 离下一个待写入字节最远的片段最晚才能被写出，优先丢弃
+  while ( str_buffer_.size() > max_fragments_
+          || str_buffer_.size() * FRAGMENT_OVERHEAD + fragment_slack_ > max_metadata_bytes_ ) {
+    erase_fragment( std::prev( str_buffer_.end() ) );
+  }
+}
+
+// 可接受字节的上界：输出流剩余容量，且不超过已知的流结束位置
+uint64_t Reassembler::window_end() const
+{
+  const uint64_t max_end = cur_index_ + output_.writer().available_capacity();
+  return have_got_end_index_ ? min( max_end, end_index_ ) : max_end;
+}
+
+void Reassembler::insert_into_ring( uint64_t first_index, string&& data )
+{
+  // 裁剪两端：只移动下标，不产生新的字符串
+  const uint64_t max_end = window_end();
+  const uint64_t begin = max( first_index, cur_index_ );
+  const uint64_t end = min( first_index + data.size(), max_end );
+  if ( begin >= end ) {
+    return;
+  }
+
+  if ( begin == cur_index_ ) {
+    // 数据连续：直接写入输出流，并清除环中被这段数据覆盖的待重组字节
+    pending_bytes_ -= mark( begin, end, false );
+    data.resize( end - first_index );
+    data.erase( 0, begin - first_index );
+    cur_index_ = end;
+    output_.writer().push( std::move( data ) );
+    drain_ring();
+    return;
+  }
+
+  // 数据不连续：拷贝进环，新到达的位置计入待重组字节数
+  pending_ring_->write( begin, string_view( data ).substr( begin - first_index, end - begin ) );
+  pending_bytes_ += mark( begin, end, true );
+}
+
+void Reassembler::drain_ring()
+{
+  if ( pending_bytes_ == 0 || output_.writer().is_closed() ) {
+    return;
+  }
+
+  const uint64_t run = run_length( cur_index_, pending_bytes_, true );
+  if ( run == 0 ) {
+    return;
+  }
+
+  // 一次性预留输出流空间，从环中整段拷贝过去
+  thread_local vector<span<char>> spans;
+  Writer& writer = output_.writer();
+  writer.reserve( run, spans );
+
+  // 只提交reserve()实际交出的空间
+  uint64_t reserved = 0;
+  uint64_t pos = cur_index_;
+  for ( const auto& region : spans ) {
+    reserved += region.size();
+    uint64_t filled = 0;
+    while ( filled < region.size() ) {
+      const string_view piece = pending_ring_->view( pos, region.size() - filled );
+      memcpy( region.data() + filled, piece.data(), piece.size() );
+      filled += piece.size();
+      pos += piece.size();
     }
   }
 
-  if ( !data.empty() ) {
-    str_buffer_[first_index] = move( data );
+  writer.commit( reserved );
+  mark( cur_index_, cur_index_ + reserved, false );
+  pending_bytes_ -= reserved;
+  cur_index_ += reserved;
+}
+
+uint64_t Reassembler::mark( uint64_t begin, uint64_t end, bool present )
+{
+  uint64_t changed = 0;
+  for_each_bit_word( pending_ring_->size(), begin, end, [&]( uint64_t word, uint64_t mask ) {
+    uint64_t& bits = present_[word];
+    const uint64_t flip = present ? ( mask & ~bits ) : ( mask & bits );
+    changed += popcount( flip );
+    bits ^= flip;
+    return true;
+  } );
+  return changed;
+}
+
+// 从begin开始连续处于给定状态（已到达/未到达）的字节数（至多max_len）
+uint64_t Reassembler::run_length( uint64_t begin, uint64_t max_len, bool present ) const
+{
+  uint64_t run = 0;
+  for_each_bit_word( pending_ring_->size(), begin, begin + max_len, [&]( uint64_t word, uint64_t mask ) {
+    const uint64_t other = mask & ( present ? ~present_[word] : present_[word] );
+    if ( other ) {
+      run += countr_zero( other ) - countr_zero( mask );
+      return false;
+    }
+    run += popcount( mask );
+    return true;
+  } );
+  return run;
+}
+
+void Reassembler::received_blocks( vector<Range>& out ) const
+{
+  out.clear();
+
+  if ( pending_ring_ ) {
+    // 交替跳过空洞、收集已到达的连续段，直到找齐所有待重组字节
+    uint64_t pos = cur_index_;
+    uint64_t remaining = pending_bytes_;
+    while ( remaining > 0 ) {
+      pos += run_length( pos, pending_ring_->size() - ( pos - cur_index_ ), false );
+      const uint64_t len = run_length( pos, remaining, true );
+      out.emplace_back( pos, pos + len );
+      pos += len;
+      remaining -= len;
+    }
+    return;
+  }
+
+  for ( const auto& [index, segment] : str_buffer_ ) {
+    if ( !out.empty() && out.back().second == index ) {
+      out.back().second += segment.size();
+    } else {
+      out.emplace_back( index, index + segment.size() );
+    }
+  }
+}
+
+void Reassembler::holes( vector<Range>& out ) const
+{
+  received_blocks( out );
+
+  // 每个空洞从上一段的末尾（或下一个待写入字节）延伸到这一段的开头
+  uint64_t hole_start = cur_index_;
+  for ( auto& [first, last] : out ) {
+    const uint64_t block_end = last;
+    last = first;
+    first = hole_start;
+    hole_start = block_end;
   }
 }
 
 uint64_t Reassembler::count_bytes_pending() const
 {
+  if ( pending_ring_ ) {
+    return pending_bytes_;
+  }
+
   uint64_t pending_bytes = 0;
 
   for ( const auto& entity : str_buffer_ ) {
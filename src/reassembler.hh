@@ -3,13 +3,37 @@
 #include "byte_stream.hh"
 #include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Bounds on the bookkeeping the Map engine keeps for out-of-order fragments. Adjacent and
+// overlapping fragments are always merged into one (fragments with a gap between them are not,
+// however small the gap); when the fragments still exceed either limit, those farthest from the
+// next needed byte are discarded (the peer will retransmit them).
+struct ReassemblerLimits
+{
+  uint64_t max_fragments { 4096 };            // Most fragments held at once
+  uint64_t max_metadata_bytes { 256 * 1024 }; // Most bytes of overhead: tree nodes and unused buffer space
+};
 
 class Reassembler
 {
 public:
+  // How bytes that arrive ahead of a gap are held until the gap is filled:
+  //   Map:  a std::map of pending substrings (one tree node and one string per fragment)
+  //   Ring: a ring sized to the output's capacity plus a presence bitmap (one copy and a few bit
+  //         operations per insert, no per-fragment allocation, and an O(1) pending count)
+  enum class Engine : uint8_t
+  {
+    Map,
+    Ring,
+  };
+
   // Construct Reassembler to write into given ByteStream.
-  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ), str_buffer_() {}
+  explicit Reassembler( ByteStream&& output, Engine engine = Engine::Map, ReassemblerLimits limits = {} );
 
   /*
    * Insert a new substring to be reassembled into a ByteStream.
@@ -37,6 +61,15 @@ public:
   // This function is for testing only; don't add extra state to support it.
   uint64_t count_bytes_pending() const;
 
+  // A range [first, last) of stream indices
+  using Range = std::pair<uint64_t, uint64_t>;
+
+  // The blocks of bytes held past the next needed byte, in stream order (replacing the contents of `out`)
+  void received_blocks( std::vector<Range>& out ) const;
+
+  // The gaps before each of those blocks that are still missing, in stream order (replacing `out`)
+  void holes( std::vector<Range>& out ) const;
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
@@ -45,8 +78,36 @@ public:
   const Writer& writer() const { return output_.writer(); }
 
 private:
+  // Map引擎的一个片段：数据位于buf_[head_, buf_.size())，前面留出的空间用于向前拼接更早的字节
+  class Fragment
+  {
+  public:
+    explicit Fragment( std::string data ) : buf_( std::move( data ) ) {}
+
+    uint64_t size() const { return buf_.size() - head_; }
+    uint64_t slack() const { return buf_.capacity() - size(); } // 数据之外占用的空间（前部预留与未用容量）
+    std::string_view view() const { return std::string_view( buf_ ).substr( head_ ); }
+
+    void append( std::string_view bytes ) { buf_.append( bytes ); }
+    // 在前面拼接bytes；空间不足时按现有长度成倍预留，但至多再预留`room`字节（之前还可能到达的字节数）
+    void prepend( std::string_view bytes, uint64_t room );
+    void remove_prefix( uint64_t len ) { head_ += len; }
+    std::string release(); // 取出数据（片段随后被丢弃）
+
+  private:
+    std::string buf_;
+    uint64_t head_ { 0 };
+  };
+
   ByteStream output_;
-  std::map<uint64_t, std::string> str_buffer_;
+  std::map<uint64_t, Fragment> str_buffer_;
+  uint64_t max_fragments_;
+  uint64_t max_metadata_bytes_;
+  uint64_t fragment_slack_ { 0 }; // 所有片段的slack()之和，计入元数据预算
+
+  // Map引擎中每个片段除数据外的开销：树节点的指针与颜色，以及key和string对象本身
+  static constexpr uint64_t FRAGMENT_OVERHEAD
+    = sizeof( decltype( str_buffer_ )::value_type ) + 4 * sizeof( void* );
 
   // 维护当前应该填入的索引
   uint64_t cur_index_ { 0 };
@@ -59,4 +120,26 @@ private:
 
   // 辅助函数：处理缓存时的去重逻辑
   void merge_into_buffer( uint64_t& first_index, std::string& data );
+
+  // 辅助函数：修改片段的起始索引（只改树节点的key，不拷贝数据）
+  void rekey( std::map<uint64_t, Fragment>::iterator it, uint64_t first_index );
+
+  // 辅助函数：删除片段，并从元数据预算中扣除它的slack
+  std::map<uint64_t, Fragment>::iterator erase_fragment( std::map<uint64_t, Fragment>::iterator it );
+
+  // 辅助函数：片段数或元数据超出限制时丢弃最远的片段
+  void enforce_limits();
+
+  // 辅助函数：可接受字节的上界（不含）
+  uint64_t window_end() const;
+
+  // Ring引擎：待重组字节按绝对位置对环大小取模存放，位图记录每个位置是否已到达
+  std::optional<RingBuffer> pending_ring_ {};
+  std::vector<uint64_t> present_ {};
+  uint64_t pending_bytes_ { 0 };
+
+  void insert_into_ring( uint64_t first_index, std::string&& data );
+  void drain_ring();
+  uint64_t mark( uint64_t begin, uint64_t end, bool present ); // 返回状态发生变化的位数
+  uint64_t run_length( uint64_t begin, uint64_t max_len, bool present ) const;
 };
@@ -0,0 +1,243 @@
+#include "ring_buffer.hh"
+#include "exception.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+namespace {
+uint64_t page_size()
+{
+  static const uint64_t size = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+  return size;
+}
+
+uint64_t round_up_to_page( uint64_t n )
+{
+  return ( n + page_size() - 1 ) / page_size() * page_size();
+}
+
+// 将fd对应的文件映射到两段相邻虚拟地址，失败时返回nullptr
+char* map_mirrored( int fd, uint64_t size )
+{
+  if ( ftruncate( fd, static_cast<off_t>( size ) ) != 0 ) {
+    return nullptr;
+  }
+
+  // 先保留2倍大小的地址空间，再用MAP_FIXED覆盖两半
+  void* reserved = mmap( nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+  if ( reserved == MAP_FAILED ) {
+    return nullptr;
+  }
+
+  auto* base = static_cast<char*>( reserved );
+  const int prot = PROT_READ | PROT_WRITE;
+  if ( mmap( base, size, prot, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED
+       || mmap( base + size, size, prot, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ) {
+    munmap( base, 2 * size );
+    return nullptr;
+  }
+  return base;
+}
+
+// 在临时目录中创建一个已unlink的文件，进程退出或关闭后自动回收
+int open_temp_file()
+{
+  const char* dir = getenv( "TMPDIR" );
+  if ( !dir || !*dir ) {
+    dir = "/tmp";
+  }
+
+  const int fd = open( dir, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600 ); // NOLINT(*-vararg)
+  if ( fd >= 0 ) {
+    return fd;
+  }
+
+  // 文件系统不支持O_TMPFILE时，退回到mkstemp + unlink
+  string path = string( dir ) + "/minnow-ring-XXXXXX";
+  const int tmp_fd = CheckSystemCall( "mkostemp", mkostemp( path.data(), O_CLOEXEC ) );
+  unlink( path.c_str() );
+  return tmp_fd;
+}
+} // namespace
+
+RingBuffer::RingBuffer( uint64_t min_size, Backing backing )
+{
+  allocate( min_size, backing );
+}
+
+RingBuffer::RingBuffer( const RingBuffer& other )
+{
+  // 物理大小相同才能保证读写位置取模结果一致
+  allocate( other.size_, other.file_ ? Backing::TempFile : Backing::Memory );
+  if ( size_ > 0 ) {
+    memcpy( base_, other.base_, size_ );
+  }
+}
+
+RingBuffer::RingBuffer( RingBuffer&& other ) noexcept
+  : base_( exchange( other.base_, nullptr ) )
+  , size_( exchange( other.size_, 0 ) )
+  , heap_( move( other.heap_ ) )
+  , file_( exchange( other.file_, nullopt ) )
+{}
+
+RingBuffer& RingBuffer::operator=( const RingBuffer& other )
+{
+  if ( this != &other ) {
+    RingBuffer copy { other };
+    *this = move( copy );
+  }
+  return *this;
+}
+
+RingBuffer& RingBuffer::operator=( RingBuffer&& other ) noexcept
+{
+  if ( this != &other ) {
+    release();
+    base_ = exchange( other.base_, nullptr );
+    size_ = exchange( other.size_, 0 );
+    heap_ = move( other.heap_ );
+    file_ = exchange( other.file_, nullopt );
+  }
+  return *this;
+}
+
+RingBuffer::~RingBuffer()
+{
+  release();
+}
+
+void RingBuffer::allocate( uint64_t min_size, Backing backing )
+{
+  if ( min_size == 0 ) {
+    return;
+  }
+
+  // 文件作为后备存储：总是双重映射，无法映射时报错
+  if ( backing == Backing::TempFile ) {
+    file_.emplace( open_temp_file() );
+    const uint64_t rounded = round_up_to_page( min_size );
+    base_ = map_mirrored( file_->fd_num(), rounded );
+    if ( !base_ ) {
+      throw unix_error( "mmap" );
+    }
+    size_ = rounded;
+    return;
+  }
+
+  // 不足一页的缓冲区直接使用堆内存，避免为小流付出映射的开销
+  if ( min_size >= page_size() ) {
+    const int fd = memfd_create( "minnow-ring", MFD_CLOEXEC );
+    if ( fd >= 0 ) {
+      const uint64_t rounded = round_up_to_page( min_size );
+      base_ = map_mirrored( fd, rounded );
+      // 映射建立后不再需要fd本身
+      close( fd );
+      if ( base_ ) {
+        size_ = rounded;
+        return;
+      }
+    }
+  }
+
+  heap_ = make_unique<char[]>( min_size );
+  base_ = heap_.get();
+  size_ = min_size;
+}
+
+void RingBuffer::release()
+{
+  if ( mirrored() ) {
+    munmap( base_, 2 * size_ );
+  }
+  heap_.reset();
+  file_.reset();
+  base_ = nullptr;
+  size_ = 0;
+}
+
+string_view RingBuffer::view( uint64_t pos, uint64_t len ) const
+{
+  if ( size_ == 0 ) {
+    return {};
+  }
+
+  const uint64_t offset = pos % size_;
+  len = min( len, size_ );
+  // 双重映射时环绕部分依然连续，否则截断到物理末尾
+  if ( !mirrored() ) {
+    len = min( len, size_ - offset );
+  }
+  return { base_ + offset, len };
+}
+
+span<char> RingBuffer::span( uint64_t pos, uint64_t len )
+{
+  const string_view region = view( pos, len );
+  return { const_cast<char*>( region.data() ), region.size() }; // NOLINT(*-const-cast)
+}
+
+void RingBuffer::write( uint64_t pos, string_view data )
+{
+  while ( !data.empty() ) {
+    const std::span<char> region = span( pos, data.size() );
+    memcpy( region.data(), data.data(), region.size() );
+    data.remove_prefix( region.size() );
+    pos += region.size();
+  }
+}
+
+template<typename Action>
+uint64_t RingBuffer::for_each_page_range( uint64_t pos, uint64_t len, const Action& action )
+{
+  if ( !file_ || len == 0 ) {
+    return pos;
+  }
+
+  // 只处理完全落在区间内的整页；size_是页大小的整数倍，所以取模后依然页对齐
+  uint64_t begin = round_up_to_page( pos );
+  const uint64_t end = ( pos + len ) / page_size() * page_size();
+  if ( begin >= end ) {
+    return pos;
+  }
+
+  while ( begin < end ) {
+    const uint64_t offset = begin % size_;
+    const uint64_t chunk = min( end - begin, size_ - offset );
+    action( offset, chunk );
+    begin += chunk;
+  }
+  return end;
+}
+
+// 以下均为建议性操作，失败时不影响正确性，因此忽略返回值
+uint64_t RingBuffer::evict( uint64_t pos, uint64_t len )
+{
+  return for_each_page_range( pos, len, [&]( uint64_t offset, uint64_t chunk ) {
+    // 先启动回写，再从两段映射中解除这些页（内容保留在文件中）
+    const auto file_offset = static_cast<off_t>( offset );
+    sync_file_range( file_->fd_num(), file_offset, static_cast<off_t>( chunk ), SYNC_FILE_RANGE_WRITE );
+    madvise( base_ + offset, chunk, MADV_DONTNEED );
+    madvise( base_ + size_ + offset, chunk, MADV_DONTNEED );
+  } );
+}
+
+uint64_t RingBuffer::discard( uint64_t pos, uint64_t len )
+{
+  return for_each_page_range( pos, len, [&]( uint64_t offset, uint64_t chunk ) {
+    // 打洞直接释放页缓存和磁盘块，避免无用的回写
+    const int mode = FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE;
+    if ( fallocate( file_->fd_num(), mode, static_cast<off_t>( offset ), static_cast<off_t>( chunk ) ) != 0 ) {
+      madvise( base_ + offset, chunk, MADV_DONTNEED );
+      madvise( base_ + size_ + offset, chunk, MADV_DONTNEED );
+    }
+  } );
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+/*
+ * RingBuffer: a fixed-size circular byte buffer, allocated once at construction.
+ *
+ * When the requested size is at least one page, the storage is mapped twice back-to-back
+ * in virtual memory (a "magic ring"), so any region of up to size() bytes is contiguous
+ * even when it wraps past the end. Otherwise (or if the double mapping fails) the
+ * storage is an ordinary heap array and regions are split at the wrap point.
+ *
+ * A ring can instead be backed by an unlinked temporary file (always double-mapped). Its
+ * pages can then be evicted from this process's memory without losing their contents:
+ * the kernel writes them back to the file and faults them in again on the next access.
+ * The file is created in $TMPDIR (default /tmp); on a tmpfs, "writing back" only moves the
+ * pages to shared memory, so eviction saves memory only on a disk-backed filesystem.
+ *
+ * Positions are absolute byte counters; the buffer reduces them modulo size().
+ */
+class RingBuffer
+{
+public:
+  enum class Backing : uint8_t
+  {
+    Memory,
+    TempFile,
+  };
+
+  explicit RingBuffer( uint64_t min_size, Backing backing = Backing::Memory );
+  RingBuffer( const RingBuffer& other );
+  RingBuffer( RingBuffer&& other ) noexcept;
+  RingBuffer& operator=( const RingBuffer& other );
+  RingBuffer& operator=( RingBuffer&& other ) noexcept;
+  ~RingBuffer();
+
+  uint64_t size() const { return size_; }                // Physical size of the storage (>= min_size)
+  bool mirrored() const { return base_ != heap_.get(); } // Is the storage double-mapped?
+
+  // Longest contiguous region of at most `len` bytes starting at position `pos`
+  std::string_view view( uint64_t pos, uint64_t len ) const;
+  std::span<char> span( uint64_t pos, uint64_t len );
+
+  // Copy `data` into the ring starting at position `pos`, wrapping around as necessary
+  void write( uint64_t pos, std::string_view data );
+
+  // For a file-backed ring: drop the whole pages inside [pos, pos + len) from memory, either
+  // keeping their contents in the file (evict) or throwing the contents away (discard).
+  // Returns the position just past the last page handled (or `pos` if there was none).
+  uint64_t evict( uint64_t pos, uint64_t len );
+  uint64_t discard( uint64_t pos, uint64_t len );
+
+private:
+  char* base_ { nullptr };
+  uint64_t size_ { 0 };
+  std::unique_ptr<char[]> heap_ {};       // Fallback storage when the double mapping is not used
+  std::optional<FileDescriptor> file_ {}; // Backing file, if any
+
+  void allocate( uint64_t min_size, Backing backing );
+  void release();
+
+  // Apply `action` to each page-aligned file range inside [pos, pos + len), split at the wrap point
+  template<typename Action>
+  uint64_t for_each_page_range( uint64_t pos, uint64_t len, const Action& action );
+};
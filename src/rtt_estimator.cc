@@ -0,0 +1,30 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+RTTEstimator::RTTEstimator( uint64_t initial_rto_ms, uint64_t min_rto_ms, uint64_t max_rto_ms )
+  : min_rto_ms_( min_rto_ms ), max_rto_ms_( max_rto_ms ), rto_ms_( initial_rto_ms )
+{}
+
+void RTTEstimator::add_sample( uint64_t rtt_ms )
+{
+  const auto rtt = static_cast<double>( rtt_ms );
+  if ( samples_ == 0 ) {
+    // 第一个样本：SRTT = R，RTTVAR = R/2
+    srtt_ms_ = rtt;
+    rttvar_ms_ = rtt / 2;
+  } else {
+    // 先用旧的SRTT更新RTTVAR（alpha = 1/8，beta = 1/4）
+    rttvar_ms_ = 0.75 * rttvar_ms_ + 0.25 * abs( srtt_ms_ - rtt );
+    srtt_ms_ = 0.875 * srtt_ms_ + 0.125 * rtt;
+  }
+  samples_++;
+  min_rtt_ms_ = min( min_rtt_ms_, rtt_ms );
+
+  // RTO = SRTT + max(G, 4 * RTTVAR)，限制在 [min_rto, max_rto] 内
+  const double rto = srtt_ms_ + max( static_cast<double>( CLOCK_GRANULARITY_MS ), 4 * rttvar_ms_ );
+  rto_ms_ = clamp( static_cast<uint64_t>( ceil( rto ) ), min_rto_ms_, max_rto_ms_ );
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+ * RTTEstimator: smoothed round-trip time and retransmission timeout (RFC 6298).
+ *
+ * Each sample is the time from sending a segment to the arrival of its acknowledgment; the
+ * caller follows Karn's rule and never samples a segment that was retransmitted. Until the
+ * first sample, rto_ms() is the initial RTO. Times are in milliseconds.
+ */
+class RTTEstimator
+{
+public:
+  static constexpr uint64_t CLOCK_GRANULARITY_MS = 1; // G: resolution of the sender's tick() clock
+
+  RTTEstimator( uint64_t initial_rto_ms, uint64_t min_rto_ms, uint64_t max_rto_ms );
+
+  void add_sample( uint64_t rtt_ms );
+
+  uint64_t rto_ms() const { return rto_ms_; }
+  uint64_t min_rto_ms() const { return min_rto_ms_; }
+  uint64_t max_rto_ms() const { return max_rto_ms_; }
+
+  bool has_samples() const { return samples_ > 0; }
+  uint64_t samples() const { return samples_; }
+  double srtt_ms() const { return srtt_ms_; }         // Smoothed RTT (0 before the first sample)
+  double rttvar_ms() const { return rttvar_ms_; }     // RTT variation (0 before the first sample)
+  uint64_t min_rtt_ms() const { return min_rtt_ms_; } // Smallest sample (UINT64_MAX before the first)
+
+private:
+  uint64_t min_rto_ms_;
+  uint64_t max_rto_ms_;
+  uint64_t rto_ms_;
+
+  uint64_t samples_ {};
+  double srtt_ms_ {};
+  double rttvar_ms_ {};
+  uint64_t min_rtt_ms_ { UINT64_MAX };
+};
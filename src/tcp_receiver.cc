@@ -1,11 +1,32 @@
 #include "tcp_receiver.hh"
+#include "tcp_config.hh"
 #include "wrapping_integers.hh"
+#include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 using namespace std;
 
-void TCPReceiver::receive( const TCPSenderMessage& message )
+TCPReceiver::TCPReceiver( Reassembler&& reassembler,
+                          bool window_scaling,
+                          optional<uint16_t> mss,
+                          bool sws_avoidance )
+  : reassembler_( std::move( reassembler ) ), window_scaling_( window_scaling ), mss_( mss )
+{
+  // 最小的移位数，使整个容量可以用16位窗口通告
+  const uint64_t capacity = reassembler_.writer().available_capacity();
+  while ( window_shift_ < TCPReceiverMessage::MAX_WINDOW_SCALE && ( capacity >> window_shift_ ) > UINT16_MAX ) {
+    window_shift_++;
+  }
+
+  if ( sws_avoidance ) {
+    const uint64_t segment = mss_.value_or( TCPConfig::MAX_PAYLOAD_SIZE );
+    sws_threshold_ = max( min( segment, capacity / 2 ), uint64_t { 1 } );
+  }
+}
+
+void TCPReceiver::receive( const TCPSenderMessage& message, bool peer_window_scaling, bool acks_syn )
 {
   if ( message.RST ) {
     // 连接错误，将字节流标记为错误状态，终止处理
@@ -18,12 +39,17 @@ void TCPReceiver::receive( const TCPSenderMessage& message )
     // 首条报文，记录起始isn
     isn_ = message.seqno;
     isn_flag_ = true;
+    sack_permitted_ = message.SACK_permitted;
+    peer_window_scaling_ = peer_window_scaling;
+    timestamps_ = message.timestamp.has_value();
+    ts_recent_ = message.timestamp;
   }
 
   if ( !isn_flag_ ) {
     // 过滤还未SYN握手的数据报
     return;
   }
+  syn_acked_ = syn_acked_ || acks_syn;
 
   // checkpoint_为字节流下一个期待的数据索引
   const uint64_t checkpoint_ = reassembler_.writer().bytes_pushed() + 1;
@@ -32,10 +58,48 @@ void TCPReceiver::receive( const TCPSenderMessage& message )
   const uint64_t abs_seqno = message.seqno.unwrap( isn_, checkpoint_ );
   const uint64_t stream_index = abs_seqno - 1 + ( message.SYN ? 1 : 0 );
 
+  duplicate_.reset();
+
+  // PAWS（RFC 7323）：时间戳早于TS.Recent的数据段来自序列号回绕之前，丢弃
+  if ( timestamps_ && !message.SYN && message.timestamp.has_value() && ts_recent_.has_value()
+       && static_cast<int32_t>( *message.timestamp - *ts_recent_ ) < 0 ) {
+    return;
+  }
+
+  // 只有从ackno或更早位置开始的数据段才更新TS.Recent，因此回显的是推进了ackno的数据段的时间戳
+  if ( timestamps_ && message.timestamp.has_value() && abs_seqno <= checkpoint_ ) {
+    ts_recent_ = message.timestamp;
+  }
+
   // 传入FIN，自动处理末尾数据状态（字节流管道由重组器关闭）
+  if ( !message.payload.empty() ) {
+    last_received_ = { stream_index, stream_index + message.payload.size() };
+    if ( sack_permitted_ ) {
+      duplicate_ = find_duplicate( last_received_ );
+    }
+  }
   reassembler_.insert( stream_index, message.payload, message.FIN );
 }
 
+optional<Reassembler::Range> TCPReceiver::find_duplicate( Reassembler::Range segment ) const
+{
+  // 已经交付到字节流中的部分
+  const uint64_t first_unassembled = reassembler_.writer().bytes_pushed();
+  if ( segment.first < first_unassembled ) {
+    return Reassembler::Range { segment.first, min( segment.second, first_unassembled ) };
+  }
+
+  // 整个落在某个已缓存的乱序块内
+  thread_local vector<Reassembler::Range> blocks;
+  reassembler_.received_blocks( blocks );
+  for ( const auto& [first, last] : blocks ) {
+    if ( first <= segment.first && segment.second <= last ) {
+      return segment;
+    }
+  }
+  return nullopt;
+}
+
 TCPReceiverMessage TCPReceiver::send() const
 {
   // 从重组器中获取feedback
@@ -59,9 +123,53 @@ TCPReceiverMessage TCPReceiver::send() const
     feedback.ackno = Wrap32::wrap( abs_ackno, isn_ );
   }
 
-  // 窗口大小，来自字节流管道，需要检查是否超出65536
-  const uint64_t pipe_capacity = reassembler_.writer().available_capacity();
-  feedback.window_size = ( pipe_capacity > UINT16_MAX ) ? UINT16_MAX : static_cast<uint16_t>( pipe_capacity );
+  // 时间戳回显
+  if ( timestamps_ ) {
+    feedback.timestamp_echo = ts_recent_;
+  }
+
+  feedback.mss = mss_;
+
+  // 窗口缩放（RFC 7323）：先发SYN时总是提供；作为应答方时只在对端提供过的情况下提供
+  if ( window_scaling_ && ( !isn_flag_ || peer_window_scaling_ ) ) {
+    feedback.window_scale = window_shift_;
+  }
+
+  // 窗口大小，来自字节流管道；双方都提供了窗口缩放时以 2^shift 为单位（向下取整），否则不能超出65535
+  // SYN上的窗口不缩放（RFC 7323 2.2），所以在对端确认本端SYN之前都按未缩放通告
+  // SWS避免（RFC 1122）：右沿 = 已读出字节数 + 容量，按阈值向下取整，只会整段推进、不会回缩
+  uint64_t pipe_capacity = reassembler_.writer().available_capacity();
+  if ( sws_threshold_ > 0 ) {
+    pipe_capacity -= min( pipe_capacity, reassembler_.reader().bytes_popped() % sws_threshold_ );
+  }
+  const uint8_t shift = ( window_scaling_ && peer_window_scaling_ && syn_acked_ ) ? window_shift_ : 0;
+  feedback.window_size = static_cast<uint16_t>( min( pipe_capacity >> shift, uint64_t { UINT16_MAX } ) );
+
+  // SACK：报告重组器中已收到的乱序数据块，包含最近收到数据段的块排在最前（RFC 2018）
+  if ( sack_permitted_ && isn_flag_ ) {
+    thread_local vector<Reassembler::Range> blocks;
+    reassembler_.received_blocks( blocks );
+
+    const auto latest = ranges::find_if( blocks, [&]( const Reassembler::Range& block ) {
+      return block.first < last_received_.second && last_received_.first < block.second;
+    } );
+    if ( latest != blocks.end() ) {
+      rotate( blocks.begin(), latest, latest + 1 );
+    }
+
+    // D-SACK排在最前（RFC 2883）
+    if ( duplicate_ ) {
+      blocks.insert( blocks.begin(), *duplicate_ );
+    }
+
+    // 流索引 -> 绝对序列号（SYN占用一个序列号）-> seqno
+    for ( const auto& [first, last] : blocks ) {
+      if ( feedback.sack_blocks.size() == TCPReceiverMessage::MAX_SACK_BLOCKS ) {
+        break;
+      }
+      feedback.sack_blocks.emplace_back( Wrap32::wrap( first + 1, isn_ ), Wrap32::wrap( last + 1, isn_ ) );
+    }
+  }
 
   return feedback;
 }
@@ -4,17 +4,25 @@
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <optional>
+
 class TCPReceiver
 {
 public:
-  // Construct with given Reassembler
-  explicit TCPReceiver( Reassembler&& reassembler ) : reassembler_( std::move( reassembler ) ) {}
+  // Construct with given Reassembler, optionally offering window scaling (RFC 7323), advertising an MSS,
+  // and avoiding the silly window syndrome (RFC 1122)
+  explicit TCPReceiver( Reassembler&& reassembler,
+                        bool window_scaling = false,
+                        std::optional<uint16_t> mss = std::nullopt,
+                        bool sws_avoidance = false );
 
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
-   * at the correct stream index.
+   * at the correct stream index. The window scale option travels with the receiver half of the
+   * peer's SYN, so whoever splits the segment says whether it was there, and whether the segment
+   * acknowledged our SYN (windows are scaled only after that, never on a SYN).
    */
-  void receive( const TCPSenderMessage& message );
+  void receive( const TCPSenderMessage& message, bool peer_window_scaling = false, bool acks_syn = false );
 
   // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
   TCPReceiverMessage send() const;
@@ -31,4 +39,29 @@ private:
   // 用于检测和保存首个数据报信息
   Wrap32 isn_ { 0 };
   bool isn_flag_ { false };
+
+  // 窗口缩放：本端是否提供、移位数（由容量决定），以及对端SYN中是否也带有该选项
+  bool window_scaling_ { false };
+  uint8_t window_shift_ { 0 };
+  bool peer_window_scaling_ { false };
+  bool syn_acked_ { false }; // 对端已确认本端SYN，此后本端不会再发送SYN，通告窗口才按移位数缩放
+
+  // 通告给对端的MSS（在SYN上）
+  std::optional<uint16_t> mss_ {};
+
+  // 接收方SWS避免：窗口右沿每次至少推进 min(MSS, 容量/2)，0表示不启用
+  uint64_t sws_threshold_ { 0 };
+
+  // 时间戳：对端SYN是否带有时间戳，以及要回显的TS.Recent
+  bool timestamps_ { false };
+  std::optional<uint32_t> ts_recent_ {};
+
+  // SACK：对端SYN是否允许，以及最近一次收到的数据段所在的流索引区间
+  bool sack_permitted_ { false };
+  Reassembler::Range last_received_ {};
+
+  // D-SACK：最近一个数据段中已经收到过的部分，在随后的ACK中作为第一个SACK块报告
+  std::optional<Reassembler::Range> duplicate_ {};
+
+  std::optional<Reassembler::Range> find_duplicate( Reassembler::Range segment ) const;
 };
@@ -1,11 +1,37 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
+#include "tcp_segment.hh"
 #include "tcp_sender_message.hh"
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <optional>
 
 using namespace std;
 
+TCPSender::TCPSender( ByteStream&& input, const TCPConfig& cfg )
+  : TCPSender( std::move( input ), cfg.isn, cfg.rt_timeout )
+{
+  sack_enabled_ = cfg.sack;
+  window_scaling_ = cfg.window_scaling;
+  timestamps_enabled_ = cfg.timestamps;
+  rtt_ = RTTEstimator { cfg.rt_timeout, cfg.rto_min, cfg.rto_max };
+  adaptive_rto_ = cfg.adaptive_rto;
+  dup_ack_threshold_ = cfg.dup_ack_threshold;
+  rack_enabled_ = cfg.rack;
+  nagle_ = !cfg.no_delay;
+  sws_avoidance_ = cfg.sws_avoidance;
+  pacing_ = cfg.pacing;
+  max_pacing_rate_ = cfg.max_pacing_rate;
+  // 协商之前不超过本端MSS
+  local_mss_ = cfg.mss;
+  mtu_probing_ = cfg.mtu_probing && cfg.mss > 0;
+  if ( local_mss_ > 0 ) {
+    mss_ = max_mss_ = mss_limit_ = min( local_mss_, uint64_t { TCPConfig::MAX_PAYLOAD_SIZE } );
+  }
+  congestion_control_ = CongestionControl::make( cfg.congestion_control, mss_ );
+}
+
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
   // 通过计算得到当前还在飞数据量
@@ -19,13 +45,32 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return consecutive_retransimissions_;
 }
 
+uint64_t TCPSender::congestion_window() const
+{
+  return congestion_control_ ? congestion_control_->cwnd() : UINT64_MAX;
+}
+
+uint64_t TCPSender::send_window() const
+{
+  // 在窗口长度为0时，默认1 byte数据；有拥塞控制时同时受cwnd（快速恢复期间加上膨胀量）限制
+  const uint64_t receive_window = ( sender_window_size_ == 0 ) ? 1 : sender_window_size_;
+  if ( !congestion_control_ ) {
+    return receive_window;
+  }
+  return min( receive_window, congestion_control_->cwnd() + recovery_inflation_ );
+}
+
 void TCPSender::push( const TransmitFunction& transmit )
 {
   // 从出站字节流管道读取数据，在字节流管道还有新数据 + 接收方window有效情况下
   // 发送需要调用传入函数参数tansmit C++11 std::function
 
-  // 在窗口长度为0时，默认1 byte数据
-  const size_t current_window_size = ( sender_window_size_ == 0 ) ? 1 : sender_window_size_;
+  // receive()中判定丢失的数据段在此重传
+  retransmit_lost( transmit );
+
+  const size_t current_window_size = send_window();
+  bool sent_new_data = false;
+  pacing_held_ = false;
 
   while ( true ) {
     const size_t bytes_in_flight_ = current_seqno_ - sender_ackno_;
@@ -41,11 +86,25 @@ void TCPSender::push( const TransmitFunction& transmit )
     if ( current_seqno_ == 0 ) {
       // SYN
       senderMessage.SYN = true;
+      senderMessage.SACK_permitted = sack_enabled_;
       space_remaining--;
     }
 
-    // 填充payload
-    const size_t limit = min( TCPConfig::MAX_PAYLOAD_SIZE, space_remaining );
+    // 不足一个MSS的数据按Nagle/cork规则暂缓发送，小窗口按SWS避免规则暂缓发送
+    if ( !senderMessage.SYN && ( hold_partial() || sws_hold() ) ) {
+      break;
+    }
+
+    // 定速发送：还有待发的数据但没到下一个数据段的发送时间，留给tick()
+    const bool pending = input_.reader().bytes_buffered() > 0 || ( input_.reader().is_finished() && !FIN_sent );
+    if ( !senderMessage.SYN && pending && now_us_ < next_departure_us_ ) {
+      pacing_held_ = true;
+      break;
+    }
+
+    // 填充payload；条件允许时这个数据段作为PLPMTUD探测段，比当前MSS更大
+    const bool probe = !senderMessage.SYN && should_probe( space_remaining );
+    const size_t limit = probe ? ( mss_ + mss_limit_ + 1 ) / 2 : min( mss_, space_remaining );
 
     // 通过peek获取实际数据（peek内部实现仅是部分连续数据，单个string，需要反复peek）
     while ( senderMessage.payload.size() < limit && input_.reader().bytes_buffered() > 0 ) {
@@ -80,13 +139,22 @@ void TCPSender::push( const TransmitFunction& transmit )
 
     // 转换类型后填入message，加入到出站数据段监听队列
     senderMessage.seqno = Wrap32::wrap( current_seqno_, isn_ );
-    outstanding_segments.emplace_back( current_seqno_, senderMessage );
+    stamp( senderMessage );
+    outstanding_segments.push_back( { current_seqno_, senderMessage, now_ms_, false, false } );
+    if ( probe ) {
+      probe_ = MTUProbe { current_seqno_, senderMessage.payload.size() };
+    }
 
     // message seqno需要填充payload后调用，且能自动处理SYN + FIN
     auto seqno_length_64 = senderMessage.sequence_length();
     current_seqno_ += seqno_length_64;
 
     transmit( senderMessage );
+    sent_new_data = true;
+    if ( congestion_control_ ) {
+      congestion_control_->on_send( seqno_length_64, now_ms_ );
+    }
+    schedule_departure( seqno_length_64 );
 
     // 发送消息后启动计时器
     if ( !timer_running_ ) {
@@ -99,6 +167,11 @@ void TCPSender::push( const TransmitFunction& transmit )
       break;
     }
   }
+
+  // 发送新数据后重新安排尾部丢失探测
+  if ( sent_new_data ) {
+    arm_tlp();
+  }
 }
 
 TCPSenderMessage TCPSender::make_empty_message() const
@@ -116,13 +189,45 @@ TCPSenderMessage TCPSender::make_empty_message() const
     empty_msg.RST = true;
   }
 
+  stamp( empty_msg );
   return empty_msg;
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::stamp( TCPSenderMessage& msg ) const
+{
+  // 主动打开时SYN上提供时间戳（被动打开时只有对端SYN提供了才会保持启用），对端回显之后每个数据段都携带
+  if ( timestamps_enabled_ && ( msg.SYN || peer_timestamps_ ) ) {
+    msg.timestamp = static_cast<uint32_t>( now_ms_ );
+  } else {
+    msg.timestamp.reset();
+  }
+}
+
+void TCPSender::receive( const TCPReceiverMessage& msg, bool segment_carries_data, bool syn_without_timestamp )
 {
   // 接收来自接收方的feedback，ackno + window size，ackno之前的数据应当从字节流管道中删除
-  sender_window_size_ = msg.window_size;
+  // 对端SYN中的移位数适用于之后所有的通告窗口；本端没有提供窗口缩放时按未缩放处理
+  // 带有该选项的是SYN，SYN上的窗口本身不缩放（RFC 7323 2.2）
+  if ( window_scaling_ && msg.window_scale.has_value() ) {
+    peer_window_shift_ = min( *msg.window_scale, TCPReceiverMessage::MAX_WINDOW_SCALE );
+  }
+  const uint8_t window_shift = msg.window_scale.has_value() ? 0 : peer_window_shift_;
+  // 对端SYN没有提供时间戳：被动打开时SYN-ACK及之后的数据段都不能携带
+  if ( syn_without_timestamp ) {
+    timestamps_enabled_ = false;
+  }
+  // 对端回显了时间戳，说明双方都支持
+  if ( timestamps_enabled_ && msg.timestamp_echo.has_value() ) {
+    peer_timestamps_ = true;
+  }
+  // 对端SYN中的MSS选项，只协商一次
+  if ( local_mss_ > 0 && !mss_negotiated_ && msg.mss.has_value() ) {
+    negotiate_mss( *msg.mss );
+  }
+
+  const uint32_t previous_window_size = sender_window_size_;
+  sender_window_size_ = static_cast<uint32_t>( msg.window_size ) << window_shift;
+  max_window_ = max( max_window_, uint64_t { sender_window_size_ } );
 
   // RST
   if ( msg.RST ) {
@@ -143,11 +248,18 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     return;
   }
 
-  if ( new_ack_64 > sender_ackno_ ) {
-    sender_ackno_ = new_ack_64;
+  // 重复ACK：不携带数据、未推进ackno、窗口不变，且仍有数据在飞（RFC 5681）
+  const bool duplicate_ack = !segment_carries_data && new_ack_64 == sender_ackno_ && !outstanding_segments.empty()
+                             && sender_window_size_ == previous_window_size && sender_window_size_ > 0;
 
-    // 重置RTO时间
-    current_RTO_ = initial_RTO_ms_;
+  const bool new_data_acked = new_ack_64 > sender_ackno_;
+  const uint64_t bytes_acked = new_ack_64 - min( new_ack_64, sender_ackno_ );
+  if ( new_data_acked ) {
+    // 快速恢复期间cwnd由恢复过程控制，不再增长
+    if ( congestion_control_ && !in_recovery_ ) {
+      congestion_control_->on_ack( bytes_acked, now_ms_ );
+    }
+    sender_ackno_ = new_ack_64;
 
     // 重置超时重传次数
     consecutive_retransimissions_ = 0;
@@ -156,17 +268,117 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     time_elapsed_ = 0;
   }
 
-  // 清理已抵达的监听数据段（通过不断弹出队头检查）
+  // 清理已抵达的监听数据段（通过不断弹出队头检查），用其中最新的一个采样RTT；
+  // 它若被重传过则无法判断ACK对应哪一次发送，本次不采样（Karn算法）
+  optional<uint64_t> rtt_sample;
   while ( !outstanding_segments.empty() ) {
     auto& entry = outstanding_segments.front();
-    const uint64_t seqno_end = entry.first + entry.second.sequence_length();
+    const uint64_t seqno_end = entry.seqno + entry.msg.sequence_length();
 
     if ( sender_ackno_ >= seqno_end ) {
+      rtt_sample = entry.retransmitted ? nullopt : optional { now_ms_ - entry.sent_at_ms };
+      if ( rack_enabled_ ) {
+        rack_update( entry );
+      }
       outstanding_segments.pop_front();
     } else {
       break;
     }
   }
+  // 有时间戳回显时，每个推进ackno的ACK都能采样，重传过的数据段也不例外（RFC 7323）
+  if ( new_data_acked && peer_timestamps_ && msg.timestamp_echo.has_value() ) {
+    rtt_sample = static_cast<uint32_t>( static_cast<uint32_t>( now_ms_ ) - *msg.timestamp_echo );
+  }
+  if ( rtt_sample ) {
+    rtt_.add_sample( *rtt_sample );
+  }
+
+  // 重置RTO时间（去掉指数退避）
+  if ( new_data_acked ) {
+    current_RTO_ = adaptive_rto_ ? rtt_.rto_ms() : initial_RTO_ms_;
+  }
+
+  // D-SACK（RFC 2883）：第一个块低于ackno或位于第二个块之内时，报告的是重复到达的数据
+  if ( !msg.sack_blocks.empty() ) {
+    const uint64_t begin = msg.sack_blocks[0].first.unwrap( isn_, sender_ackno_ );
+    const uint64_t end = msg.sack_blocks[0].second.unwrap( isn_, sender_ackno_ );
+    bool duplicate = begin < end && begin < sender_ackno_;
+    if ( msg.sack_blocks.size() > 1 ) {
+      const uint64_t second_begin = msg.sack_blocks[1].first.unwrap( isn_, sender_ackno_ );
+      const uint64_t second_end = msg.sack_blocks[1].second.unwrap( isn_, sender_ackno_ );
+      duplicate = duplicate || ( second_begin <= begin && begin < end && end <= second_end );
+    }
+    if ( duplicate ) {
+      process_dsack( begin, end );
+    }
+  }
+
+  // Eifel检测（RFC 3522）：确认了本次事件的数据，回显的却是事件开始之前发送的时间戳，说明是原始数据到达了
+  if ( new_data_acked && undo_valid_ && undo_retransmits_ > 0 && peer_timestamps_ && msg.timestamp_echo.has_value()
+       && static_cast<int32_t>( *msg.timestamp_echo - static_cast<uint32_t>( undo_ts_ ) ) < 0 ) {
+    undo_loss_episode();
+  }
+
+  // 更新SACK记分板：只接受位于ackno与已发送位置之间的块，已被累计确认的部分直接丢弃
+  for ( const auto& [left, right] : msg.sack_blocks ) {
+    const uint64_t begin = left.unwrap( isn_, sender_ackno_ );
+    const uint64_t end = right.unwrap( isn_, sender_ackno_ );
+    if ( sender_ackno_ <= begin && begin < end && end <= current_seqno_ ) {
+      record_sack( begin, end );
+    }
+  }
+  while ( !sacked_.empty() && sacked_.begin()->first < sender_ackno_ ) {
+    const auto node = sacked_.extract( sacked_.begin() );
+    if ( node.mapped() > sender_ackno_ ) {
+      sacked_.emplace( sender_ackno_, node.mapped() );
+    }
+  }
+
+  // PLPMTUD：探测段被累计确认或完整SACK，说明路径能通过更大的数据段
+  if ( probe_ ) {
+    const auto probe = ranges::find_if( outstanding_segments, [&]( const auto& s ) { return is_probe( s ); } );
+    if ( sender_ackno_ >= probe_->seqno + probe_->size
+         || ( probe != outstanding_segments.end() && fully_sacked( *probe ) ) ) {
+      set_mss( probe_->size );
+      probe_.reset();
+    }
+  }
+
+  // RACK：被累计确认或完整SACK的数据段都算作已交付，据此判断更早发送的数据段是否丢失
+  if ( rack_enabled_ ) {
+    for ( const auto& segment : outstanding_segments ) {
+      if ( fully_sacked( segment ) ) {
+        rack_update( segment );
+      }
+    }
+    rack_detect_losses();
+  }
+
+  // 快速重传与快速恢复
+  if ( new_data_acked ) {
+    dup_acks_ = 0;
+    if ( in_recovery_ && sender_ackno_ >= recovery_point_ ) {
+      // 完全确认：退出恢复，窗口回落到ssthresh
+      in_recovery_ = false;
+      recovery_inflation_ = 0;
+    } else if ( in_recovery_ ) {
+      // 部分确认：下一个空洞同样已丢失，立即重传；窗口扣除新确认的量，再补回一个MSS
+      recovery_inflation_ -= min( recovery_inflation_, bytes_acked );
+      recovery_inflation_ += mss_;
+      outstanding_segments.front().lost = true;
+    }
+  } else if ( duplicate_ack && dup_ack_threshold_ > 0 ) {
+    dup_acks_++;
+    if ( in_recovery_ ) {
+      recovery_inflation_ += mss_;
+    } else if ( dup_acks_ == dup_ack_threshold_ && sender_ackno_ > recovery_point_ ) {
+      // 丢失的只是探测段时不是拥塞信号，重传时再降低搜索上限
+      if ( !is_probe( outstanding_segments.front() ) ) {
+        enter_recovery();
+      }
+      outstanding_segments.front().lost = true;
+    }
+  }
 
   // 关闭当前计时器
   if ( outstanding_segments.empty() ) {
@@ -175,33 +387,443 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
   } else {
     timer_running_ = true;
   }
+
+  // 新的确认说明探测（如有）已有结果，重新安排下一次探测
+  if ( new_data_acked ) {
+    tlp_outstanding_ = false;
+  }
+  arm_tlp();
 }
 
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
   // 传入参数 ms_since_last_tick 为从上一个时间刻到现在的毫秒数差值
+  tick_us( ms_since_last_tick * 1000, transmit );
+}
+
+void TCPSender::tick_us( uint64_t us_since_last_tick, const TransmitFunction& transmit )
+{
+  // 微秒时钟只用于定速发送，其余计时以毫秒为单位，不足1毫秒的部分留到下一次
+  now_us_ += us_since_last_tick;
+  const uint64_t ms_since_last_tick = now_us_ / 1000 - now_ms_;
+  now_ms_ += ms_since_last_tick;
+
+  // 到了定速发送留下的数据段的发送时间
+  if ( pacing_held_ && now_us_ >= next_departure_us_ ) {
+    push( transmit );
+  }
+
   if ( !timer_running_ ) {
     return;
   }
 
   time_elapsed_ += ms_since_last_tick;
 
+  // RACK重排序窗口到期：重新判定丢失并立即重传
+  if ( rack_deadline_ && now_ms_ >= *rack_deadline_ ) {
+    rack_deadline_.reset();
+    rack_detect_losses();
+    retransmit_lost( transmit );
+  }
+
+  // 尾部丢失探测：重传最后一个数据段，让接收方的ACK/SACK暴露尾部的丢失，之后重新启动RTO计时器
+  if ( tlp_deadline_ && now_ms_ >= *tlp_deadline_ ) {
+    tlp_deadline_.reset();
+    if ( !in_recovery_ && !outstanding_segments.empty() && sender_window_size_ > 0 ) {
+      // 探测本身不缩减窗口，不计入可撤销的丢失事件
+      undo_valid_ = false;
+      retransmit_missing( outstanding_segments.back(), transmit );
+      tlp_outstanding_ = true;
+      time_elapsed_ = 0;
+    }
+  }
+
   if ( time_elapsed_ >= current_RTO_ ) {
     // 骑手已超时
+    // 第一次超时（且不在快速恢复中）开始新的丢失事件，记录可撤销的状态；零窗口探测超时不算
+    if ( consecutive_retransimissions_ == 0 && !in_recovery_ && sender_window_size_ > 0 ) {
+      begin_loss_episode();
+    }
+
+    // 连续超时：较大的数据段可能被路径黑洞丢弃（RFC 4821），退回较小的MSS后再重传
+    if ( mtu_probing_ && consecutive_retransimissions_ >= MTU_BLACK_HOLE_RTOS && !outstanding_segments.empty() ) {
+      const uint64_t fallback = max( min( mss_ / 2, uint64_t { TCPConfig::MAX_PAYLOAD_SIZE } ), MIN_MSS );
+      if ( outstanding_segments.front().msg.payload.size() > fallback ) {
+        mss_limit_ = min( mss_limit_, mss_ - 1 );
+        set_mss( fallback );
+      }
+    }
+
+    // 接收方可能已经丢弃了SACK过的数据（RFC 2018 8）：超时后清空SACK记分板，完整重传最早的数据段
+    sacked_.clear();
     if ( !outstanding_segments.empty() ) {
       // 不对每个segment进行追踪，而是维护队列中最早没被确认的包
-      auto& segment = outstanding_segments.front();
-      const TCPSenderMessage msg = segment.second;
-
-      transmit( msg );
+      retransmit_missing( outstanding_segments.front(), transmit );
     }
 
-    // RTO翻倍，仅在传回窗口大小不为0时才进行，窗口为0说明对应探测包
+    // RTO翻倍，仅在传回窗口大小不为0时才进行，窗口为0说明对应探测包（探测超时也不视为拥塞）
     if ( sender_window_size_ > 0 ) {
-      current_RTO_ *= 2;
+      current_RTO_ = min( current_RTO_ * 2, rtt_.max_rto_ms() );
+      if ( congestion_control_ ) {
+        congestion_control_->on_rto( sequence_numbers_in_flight(), now_ms_ );
+      }
+    }
+
+    // 超时结束快速恢复；超时前已发送的数据被确认之前，不再由重复ACK触发恢复
+    in_recovery_ = false;
+    recovery_inflation_ = 0;
+    recovery_point_ = current_seqno_;
+    dup_acks_ = 0;
+    for ( auto& segment : outstanding_segments ) {
+      segment.lost = false;
     }
+    rack_deadline_.reset();
+    tlp_deadline_.reset();
+    tlp_outstanding_ = false;
 
     time_elapsed_ = 0;
     consecutive_retransimissions_++;
   }
 }
+
+void TCPSender::record_sack( uint64_t begin, uint64_t end )
+{
+  // 与已有的重叠或相邻区间合并
+  auto it = sacked_.upper_bound( begin );
+  if ( it != sacked_.begin() && prev( it )->second >= begin ) {
+    --it;
+    begin = it->first;
+  }
+  while ( it != sacked_.end() && it->first <= end ) {
+    end = max( end, it->second );
+    it = sacked_.erase( it );
+  }
+  sacked_.emplace( begin, end );
+}
+
+bool TCPSender::fully_sacked( const OutstandingSegment& segment ) const
+{
+  auto it = sacked_.upper_bound( segment.seqno );
+  if ( it == sacked_.begin() ) {
+    return false;
+  }
+  --it;
+  return it->second >= segment.seqno + segment.msg.sequence_length();
+}
+
+// 重传一个数据段中未被SACK覆盖的部分（无SACK信息时即整个数据段）
+void TCPSender::retransmit_missing( OutstandingSegment& segment, const TransmitFunction& transmit )
+{
+  segment.sent_at_ms = now_ms_;
+  segment.retransmitted = true;
+  stamp( segment.msg );
+
+  // 探测段需要重传，说明它（很可能）没能通过路径
+  if ( is_probe( segment ) ) {
+    probe_failed();
+  }
+
+  const uint64_t start = segment.seqno;
+  const TCPSenderMessage& msg = segment.msg;
+  const uint64_t end = start + msg.sequence_length();
+
+  // 丢失事件中的每次重传都要被D-SACK证明多余，事件才能撤销
+  const auto send = [&]( const TCPSenderMessage& m ) {
+    if ( undo_valid_ ) {
+      undo_retransmits_++;
+    }
+    transmit( m );
+  };
+
+  const auto send_piece = [&]( uint64_t first, uint64_t last ) {
+    if ( first == start && last == end ) {
+      send( msg );
+      return;
+    }
+
+    // 截取[first, last)：SYN占据起点，FIN占据终点，其余为payload
+    const uint64_t payload_start = start + msg.SYN;
+    const uint64_t payload_end = payload_start + msg.payload.size();
+    const uint64_t payload_first = max( first, payload_start ) - payload_start;
+    const uint64_t payload_last = clamp( last, payload_start, payload_end ) - payload_start;
+
+    TCPSenderMessage piece = make_empty_message();
+    piece.seqno = Wrap32::wrap( first, isn_ );
+    piece.SYN = msg.SYN && first == start;
+    piece.SACK_permitted = piece.SYN && msg.SACK_permitted;
+    piece.timestamp = msg.timestamp;
+    piece.payload = msg.payload.substr( payload_first, payload_last - payload_first );
+    piece.FIN = msg.FIN && last == end;
+    send( piece );
+  };
+
+  // 超过当前MSS的数据段（失败的探测段，或MSS退回之前发送的）按MSS切分后重传
+  const auto send_range = [&]( uint64_t first, uint64_t last ) {
+    const uint64_t step = msg.payload.size() > mss_ ? mss_ : last - first;
+    for ( ; first < last; first += step ) {
+      send_piece( first, min( first + step, last ) );
+    }
+  };
+
+  if ( sacked_.empty() ) {
+    send_range( start, end );
+    return;
+  }
+
+  // 已被累计确认的前缀也无需重传
+  uint64_t pos = max( start, sender_ackno_ );
+  auto it = sacked_.upper_bound( start );
+  if ( it != sacked_.begin() ) {
+    --it;
+  }
+  for ( ; it != sacked_.end() && it->first < end && pos < end; ++it ) {
+    if ( it->second <= pos ) {
+      continue;
+    }
+    if ( it->first > pos ) {
+      send_range( pos, it->first );
+    }
+    pos = it->second;
+  }
+  if ( pos < end ) {
+    send_range( pos, end );
+  }
+}
+
+void TCPSender::retransmit_lost( const TransmitFunction& transmit )
+{
+  for ( auto& segment : outstanding_segments ) {
+    if ( segment.lost ) {
+      segment.lost = false;
+      retransmit_missing( segment, transmit );
+    }
+  }
+}
+
+void TCPSender::enter_recovery()
+{
+  // 一个窗口的数据内只响应一次丢失
+  if ( in_recovery_ || sender_ackno_ <= recovery_point_ ) {
+    return;
+  }
+  in_recovery_ = true;
+  recovery_point_ = current_seqno_;
+  recovery_inflation_ = dup_acks_ * mss_;
+  begin_loss_episode();
+  if ( congestion_control_ ) {
+    congestion_control_->on_loss( sequence_numbers_in_flight(), now_ms_ );
+  }
+}
+
+void TCPSender::begin_loss_episode()
+{
+  undo_valid_ = true;
+  undo_start_ = sender_ackno_;
+  undo_retransmits_ = 0;
+  undo_rto_ = current_RTO_;
+  undo_ts_ = now_ms_;
+  if ( congestion_control_ ) {
+    congestion_control_->save_undo_state();
+  }
+}
+
+void TCPSender::process_dsack( uint64_t begin, uint64_t end )
+{
+  // 同一个D-SACK块可能随多个ACK重复到达，只计一次；只统计本次丢失事件中重传的数据
+  if ( pair { begin, end } == last_dsack_ ) {
+    return;
+  }
+  last_dsack_ = { begin, end };
+  if ( !undo_valid_ || begin < undo_start_ || undo_retransmits_ == 0 ) {
+    return;
+  }
+  if ( --undo_retransmits_ == 0 ) {
+    undo_loss_episode();
+  }
+}
+
+void TCPSender::undo_loss_episode()
+{
+  // 重传是多余的：原始数据并未丢失，撤销本次事件的窗口缩减与RTO退避（RFC 4015）
+  undo_valid_ = false;
+  spurious_++;
+  if ( congestion_control_ ) {
+    congestion_control_->undo();
+  }
+  current_RTO_ = min( current_RTO_, undo_rto_ );
+  consecutive_retransimissions_ = 0;
+  in_recovery_ = false;
+  recovery_inflation_ = 0;
+  for ( auto& segment : outstanding_segments ) {
+    segment.lost = false;
+  }
+}
+
+void TCPSender::rack_update( const OutstandingSegment& segment )
+{
+  // 重传过的数据段若RTT短于最小RTT，ACK可能对应的是原始发送，不能据此推进RACK
+  const uint64_t rtt = now_ms_ - segment.sent_at_ms;
+  if ( segment.retransmitted && rtt < rtt_.min_rtt_ms() ) {
+    return;
+  }
+
+  const uint64_t end = segment.seqno + segment.msg.sequence_length();
+  if ( segment.sent_at_ms > rack_xmit_ts_ || ( segment.sent_at_ms == rack_xmit_ts_ && end > rack_end_seq_ ) ) {
+    rack_xmit_ts_ = segment.sent_at_ms;
+    rack_end_seq_ = end;
+    rack_rtt_ = rtt;
+  }
+}
+
+void TCPSender::rack_detect_losses()
+{
+  if ( rack_end_seq_ == 0 ) {
+    return;
+  }
+
+  // 重排序窗口：min_RTT / 4，且不超过SRTT
+  const uint64_t reo_wnd
+    = rtt_.has_samples() ? min( rtt_.min_rtt_ms() / 4, static_cast<uint64_t>( rtt_.srtt_ms() ) ) : 0;
+
+  // 比RACK数据段更早发送、且超过 RACK.rtt + reo_wnd 仍未交付的数据段判定为丢失；
+  // 尚未超时的数据段决定下一次检查的时间
+  bool found_loss = false;
+  rack_deadline_.reset();
+  for ( auto& segment : outstanding_segments ) {
+    const uint64_t end = segment.seqno + segment.msg.sequence_length();
+    const bool sent_before_rack
+      = segment.sent_at_ms < rack_xmit_ts_ || ( segment.sent_at_ms == rack_xmit_ts_ && end < rack_end_seq_ );
+    if ( segment.lost || !sent_before_rack || fully_sacked( segment ) ) {
+      continue;
+    }
+
+    const uint64_t deadline = segment.sent_at_ms + rack_rtt_ + reo_wnd;
+    if ( now_ms_ >= deadline ) {
+      segment.lost = true;
+      found_loss = found_loss || !is_probe( segment );
+    } else {
+      rack_deadline_ = min( rack_deadline_.value_or( deadline ), deadline );
+    }
+  }
+
+  if ( found_loss ) {
+    enter_recovery();
+  }
+}
+
+void TCPSender::arm_tlp()
+{
+  // 只在有数据在飞、不处于恢复、没有未决的探测且已有RTT样本时安排探测
+  if ( !rack_enabled_ || outstanding_segments.empty() || in_recovery_ || tlp_outstanding_ || !rtt_.has_samples() ) {
+    tlp_deadline_.reset();
+    return;
+  }
+
+  // PTO = 2 * SRTT（只有一个数据段在飞时再加上延迟ACK的余量），且不晚于RTO
+  uint64_t pto = static_cast<uint64_t>( ceil( 2 * rtt_.srtt_ms() ) );
+  if ( outstanding_segments.size() == 1 ) {
+    pto += TLP_DELAYED_ACK_ALLOWANCE_MS;
+  }
+  pto = min( pto, current_RTO_ - min( time_elapsed_, current_RTO_ ) );
+  tlp_deadline_ = now_ms_ + pto;
+}
+
+void TCPSender::negotiate_mss( uint16_t peer_mss )
+{
+  // 不超过双方的MSS，并为数据段上的选项留出空间：SACK块可能占满全部选项空间
+  mss_negotiated_ = true;
+  const uint64_t mss = min( uint64_t { peer_mss }, local_mss_ );
+  const uint64_t options = sack_enabled_         ? TCPSegment::MAX_OPTIONS_LENGTH
+                           : timestamps_enabled_ ? TCPSegment::TIMESTAMPS_SPACE
+                                                 : 0;
+  max_mss_ = max( mss - min( mss, options ), MIN_MSS );
+  mss_limit_ = max_mss_;
+
+  // 启用PLPMTUD时从保守的MAX_PAYLOAD_SIZE开始向上探测，否则直接使用协商结果
+  set_mss( mtu_probing_ ? min( max_mss_, uint64_t { TCPConfig::MAX_PAYLOAD_SIZE } ) : max_mss_ );
+}
+
+void TCPSender::set_mss( uint64_t mss )
+{
+  mss_ = mss;
+  if ( congestion_control_ ) {
+    congestion_control_->set_mss( mss );
+  }
+}
+
+bool TCPSender::hold_partial() const
+{
+  // 按缓冲区中的数据量判断，不按窗口：窗口限制下的小数据段不在这里处理
+  const uint64_t buffered = input_.reader().bytes_buffered();
+  if ( buffered == 0 || buffered >= mss_ || sender_window_size_ == 0 ) {
+    return false;
+  }
+  // 流已关闭：剩下的数据连同FIN一起发出
+  if ( input_.writer().is_closed() ) {
+    return false;
+  }
+  return corked_ || ( nagle_ && sequence_numbers_in_flight() > 0 );
+}
+
+bool TCPSender::sws_hold() const
+{
+  // 只看接收方窗口的剩余空间（拥塞窗口不受此限）；数据足够填满它时才算小窗口，零窗口探测不受限制
+  const uint64_t window_end = sender_ackno_ + sender_window_size_;
+  const uint64_t usable = window_end - min( window_end, current_seqno_ );
+  return sws_avoidance_ && sender_window_size_ > 0 && input_.reader().bytes_buffered() > usable && usable < mss_
+         && usable < max_window_ / 2 && sequence_numbers_in_flight() > 0;
+}
+
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( !pacing_ ) {
+    return 0;
+  }
+  uint64_t rate = 0;
+  if ( congestion_control_ && rtt_.srtt_ms() > 0 ) {
+    const double gain = congestion_control_->in_slow_start() ? 2.0 : 1.2;
+    rate = static_cast<uint64_t>( gain * static_cast<double>( congestion_window() ) * 1000 / rtt_.srtt_ms() );
+  }
+  if ( max_pacing_rate_ > 0 ) {
+    rate = rate == 0 ? max_pacing_rate_ : min( rate, max_pacing_rate_ );
+  }
+  return rate;
+}
+
+optional<uint64_t> TCPSender::time_until_departure_us() const
+{
+  if ( !pacing_held_ ) {
+    return nullopt;
+  }
+  return next_departure_us_ - min( now_us_, next_departure_us_ );
+}
+
+void TCPSender::schedule_departure( uint64_t bytes )
+{
+  // tick()的时钟较粗，落后不超过PACING_SLACK_US的部分可以补发；空闲之后不积攒更多的发送额度
+  const uint64_t rate = pacing_rate();
+  if ( rate > 0 ) {
+    const uint64_t earliest = now_us_ - min( now_us_, PACING_SLACK_US );
+    next_departure_us_ = max( next_departure_us_, earliest ) + bytes * 1'000'000 / rate;
+  }
+}
+
+bool TCPSender::is_probe( const OutstandingSegment& segment ) const
+{
+  return probe_ && segment.seqno == probe_->seqno;
+}
+
+bool TCPSender::should_probe( uint64_t space_remaining ) const
+{
+  // 一次只探测一个，恢复期间不探测；探测段要能一次发出，且不能因此多等待数据
+  const uint64_t size = ( mss_ + mss_limit_ + 1 ) / 2;
+  return mtu_probing_ && !probe_ && !in_recovery_ && mss_limit_ >= mss_ + MTU_PROBE_THRESHOLD
+         && space_remaining >= size && input_.reader().bytes_buffered() >= size;
+}
+
+void TCPSender::probe_failed()
+{
+  // 探测段丢失不缩减拥塞窗口，只把搜索上限降到探测大小以下
+  mss_limit_ = max( probe_->size - 1, mss_ );
+  probe_.reset();
+}
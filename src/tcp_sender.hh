@@ -1,11 +1,19 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "rtt_estimator.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <utility>
 
 class TCPSender
 {
@@ -16,14 +24,22 @@ public:
     , isn_( isn )
     , initial_RTO_ms_( initial_RTO_ms )
     , outstanding_segments()
+    , rtt_( initial_RTO_ms, 0, UINT64_MAX )
     , current_RTO_( initial_RTO_ms )
   {}
 
+  /* Construct TCP sender with the ISN, RTO and TCP extensions chosen in a TCPConfig */
+  TCPSender( ByteStream&& input, const TCPConfig& cfg );
+
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage make_empty_message() const;
 
-  /* Receive and process a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive and process a TCPReceiverMessage from the peer's receiver.
+   * Only pure ACKs (arriving on segments that carry no data) count as duplicate ACKs.
+   * A peer SYN without a timestamp turns timestamps off for the connection (RFC 7323 3.2). */
+  void receive( const TCPReceiverMessage& msg,
+                bool segment_carries_data = false,
+                bool syn_without_timestamp = false );
 
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( const TCPSenderMessage& )>;
@@ -31,12 +47,30 @@ public:
   /* Push bytes from the outbound stream */
   void push( const TransmitFunction& transmit );
 
+  /* Hold back partial segments (even with nothing in flight) until uncorked; push() afterwards to flush */
+  void set_corked( bool corked ) { corked_ = corked; }
+
   /* Time has passed by the given # of milliseconds since the last time the tick() method was called */
   void tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit );
 
+  /* The same, for callers with a finer clock: paced segments leave on a microsecond schedule */
+  void tick_us( uint64_t us_since_last_tick, const TransmitFunction& transmit );
+
   // Accessors
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive retransmissions have happened?
+  uint64_t congestion_window() const;           // Congestion window (UINT64_MAX without congestion control)
+  const CongestionControl* congestion_control() const { return congestion_control_.get(); }
+  const RTTEstimator& rtt() const { return rtt_; }                 // SRTT, RTTVAR and min-RTT of the path
+  uint64_t retransmission_timeout() const { return current_RTO_; } // Current RTO, including backoff
+  bool in_fast_recovery() const { return in_recovery_; }           // Repairing a loss found by duplicate ACKs?
+  uint64_t mss() const { return mss_; }                            // Payload of a full-sized segment
+  uint64_t max_mss() const { return max_mss_; }                    // Largest payload the connection allows
+  uint64_t spurious_retransmissions() const { return spurious_; }  // Loss episodes undone as spurious
+  bool corked() const { return corked_; }                          // Holding back partial segments?
+  uint64_t pacing_rate() const;                                    // Bytes per second (0 = not paced)
+  // How long until a segment held back by pacing may leave (nullopt if none is held), for the event loop's sleep
+  std::optional<uint64_t> time_until_departure_us() const;
   const Writer& writer() const { return input_.writer(); }
   const Reader& reader() const { return input_.reader(); }
   Writer& writer() { return input_.writer(); }
@@ -52,10 +86,133 @@ private:
   bool FIN_sent { false };            // FIN包是否已经发送
   uint64_t current_seqno_ { 0 };      // 当前的绝对序列号
   uint64_t sender_ackno_ { 0 };       // 接收端返回的ackno，receive更新
-  uint16_t sender_window_size_ { 1 }; // 同上，window size，需要遵照F&Q初始化为1
+  uint32_t sender_window_size_ { 1 }; // 同上，window size（已按窗口缩放还原），需要遵照F&Q初始化为1
+
+  // 窗口缩放（RFC 7323）：本端是否提供，以及对端SYN中给出的移位数
+  bool window_scaling_ { false };
+  uint8_t peer_window_shift_ { 0 };
+
+  // 时间戳（RFC 7323）：本端是否提供，以及对端是否已经回显过（此后每个数据段都携带时间戳）
+  bool timestamps_enabled_ { false };
+  bool peer_timestamps_ { false };
+
+  void stamp( TCPSenderMessage& msg ) const;
 
   // 监听还在飞的数据段
-  std::deque<std::pair<uint64_t, TCPSenderMessage>> outstanding_segments;
+  struct OutstandingSegment
+  {
+    uint64_t seqno;       // 绝对序列号
+    TCPSenderMessage msg; // 原始报文
+    uint64_t sent_at_ms;  // 最近一次发送的时间
+    bool retransmitted;   // 是否被重传过（Karn算法：重传过的数据段不采样RTT）
+    bool lost;            // 已判定丢失（重复ACK或RACK），等待重传
+  };
+  std::deque<OutstandingSegment> outstanding_segments;
+
+  // SACK记分板：接收方报告已收到的绝对序列号区间 [begin, end)，按begin排序且互不相邻
+  bool sack_enabled_ { false };
+  std::map<uint64_t, uint64_t> sacked_ {};
+
+  void record_sack( uint64_t begin, uint64_t end );
+  bool fully_sacked( const OutstandingSegment& segment ) const;
+  void retransmit_missing( OutstandingSegment& segment, const TransmitFunction& transmit );
+  void retransmit_lost( const TransmitFunction& transmit );
+
+  // 快速重传与NewReno快速恢复（RFC 5681/6582）
+  uint64_t dup_ack_threshold_ { 0 };  // 触发快速重传的重复ACK数，0表示不启用
+  uint64_t dup_acks_ { 0 };           // 连续收到的重复ACK数
+  bool in_recovery_ { false };        // 是否处于快速恢复
+  uint64_t recovery_point_ { 0 };     // 进入恢复时已发送的最高序列号，确认越过它才能再次进入恢复
+  uint64_t recovery_inflation_ { 0 }; // 恢复期间的窗口膨胀量：每个重复ACK代表一个已离开网络的数据段
+
+  uint64_t send_window() const;
+  void enter_recovery();
+
+  // RACK-TLP（RFC 8985）：按发送时间判定丢失，并用尾部丢失探测代替大多数尾部超时
+  static constexpr uint64_t TLP_DELAYED_ACK_ALLOWANCE_MS = 200; // 只有一个数据段在飞时，为延迟ACK预留的时间
+  bool rack_enabled_ { false };
+  uint64_t rack_xmit_ts_ { 0 };              // 已交付数据段中最晚的发送时间
+  uint64_t rack_end_seq_ { 0 };              // 该数据段的结束序列号（0表示尚无）
+  uint64_t rack_rtt_ { 0 };                  // 该数据段的RTT
+  std::optional<uint64_t> rack_deadline_ {}; // 重排序定时器到期时间
+  std::optional<uint64_t> tlp_deadline_ {};  // 尾部丢失探测到期时间
+  bool tlp_outstanding_ { false };           // 已发出探测，等待新的确认
+
+  void rack_update( const OutstandingSegment& segment );
+  void rack_detect_losses();
+  void arm_tlp();
+
+  // 虚假重传检测（D-SACK，RFC 3708；时间戳，RFC 3522）与撤销（Eifel响应，RFC 4015）：一次丢失事件中的
+  // 每个重传都被D-SACK报告为重复，或确认回显的时间戳早于重传时，说明原始数据并未丢失，
+  // 恢复事件开始前的拥塞状态和RTO
+  bool undo_valid_ { false };                   // 当前丢失事件是否仍可撤销
+  uint64_t undo_start_ { 0 };                   // 事件开始时的ackno，只有之后的数据才属于本次事件
+  uint64_t undo_retransmits_ { 0 };             // 本次事件中尚未被证明多余的重传数
+  uint64_t undo_rto_ { 0 };                     // 事件开始前的RTO
+  uint64_t undo_ts_ { 0 };                      // 事件开始的时间
+  std::pair<uint64_t, uint64_t> last_dsack_ {}; // 最近处理过的D-SACK块（同一块可能随多个ACK重复到达）
+  uint64_t spurious_ { 0 };                     // 被撤销的丢失事件数
+
+  void begin_loss_episode();
+  void process_dsack( uint64_t begin, uint64_t end );
+  void undo_loss_episode();
+
+  // MSS与分组层路径MTU发现（PLPMTUD，RFC 4821）：从MAX_PAYLOAD_SIZE开始，每次用一个更大的探测段
+  // 二分逼近协商出的MSS；探测段丢失只降低搜索上限，不视为拥塞；连续超时时（可能是路径黑洞）退回较小的MSS
+  static constexpr uint64_t MIN_MSS = 48;             // 退回时的下限
+  static constexpr uint64_t MTU_PROBE_THRESHOLD = 32; // 搜索区间小于此值时不再探测
+  static constexpr uint64_t MTU_BLACK_HOLE_RTOS = 2;  // 连续超时达到此次数后退回较小的MSS
+  struct MTUProbe
+  {
+    uint64_t seqno; // 探测段的绝对序列号
+    uint64_t size;  // 探测段的payload大小
+  };
+  uint64_t local_mss_ { 0 };                           // 本端MSS（0表示不协商）
+  bool mss_negotiated_ { false };                      // 是否已收到对端的MSS选项
+  bool mtu_probing_ { false };                         // 是否启用PLPMTUD
+  uint64_t mss_ { TCPConfig::MAX_PAYLOAD_SIZE };       // 满载数据段的payload大小（搜索下限）
+  uint64_t max_mss_ { TCPConfig::MAX_PAYLOAD_SIZE };   // 协商出的MSS，已扣除选项空间
+  uint64_t mss_limit_ { TCPConfig::MAX_PAYLOAD_SIZE }; // 搜索上限：尚未被证明过大的最大payload
+  std::optional<MTUProbe> probe_ {};                   // 在飞的探测段
+
+  void negotiate_mss( uint16_t peer_mss );
+  void set_mss( uint64_t mss );
+  bool is_probe( const OutstandingSegment& segment ) const;
+  bool should_probe( uint64_t space_remaining ) const;
+  void probe_failed();
+
+  // Nagle算法（RFC 896）与cork：不足一个MSS的数据先留在缓冲区。Nagle只在有数据在飞时等待，
+  // cork一直等到凑满一个MSS或被解除；结束流的最后一段（带FIN）与零窗口探测不受限制
+  bool nagle_ { false };
+  bool corked_ { false };
+
+  bool hold_partial() const;
+
+  // 发送方SWS避免（RFC 1122）：窗口只容得下一个小数据段、且不到对端最大窗口的一半时，
+  // 只要还有数据在飞，就等待窗口继续打开
+  bool sws_avoidance_ { false };
+  uint64_t max_window_ { 0 }; // 对端通告过的最大窗口
+
+  bool sws_hold() const;
+
+  // 定速发送（EDT）：每个新数据段按 长度/速率 推迟下一个数据段的最早发送时间，到时由tick()发出；
+  // 速率为 cwnd/SRTT 乘以增益（慢启动2倍、拥塞避免1.2倍，使窗口仍能增长），并受配置的上限限制
+  static constexpr uint64_t PACING_SLACK_US = 1000; // 允许落后的时间：一个毫秒级tick
+  bool pacing_ { false };
+  uint64_t max_pacing_rate_ { 0 };   // 速率上限（字节/秒），0表示不限
+  uint64_t now_us_ { 0 };            // tick累计的时间（微秒）
+  uint64_t next_departure_us_ { 0 }; // 下一个新数据段的最早发送时间
+  bool pacing_held_ { false };       // push()是否因定速而留下了数据
+
+  void schedule_departure( uint64_t bytes );
+
+  // 拥塞控制（为空时只受接收方窗口限制），now_ms_为tick累计的时间
+  std::unique_ptr<CongestionControl> congestion_control_ {};
+  uint64_t now_ms_ { 0 };
+
+  // RTT估计（RFC 6298），adaptive_rto_为false时RTO固定为initial_RTO_ms_
+  RTTEstimator rtt_;
+  bool adaptive_rto_ { false };
 
   // 计时器
   size_t current_RTO_ { 0 };                  // 当前RTO（指数退缩）
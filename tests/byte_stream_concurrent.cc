@@ -0,0 +1,123 @@
+#include "concurrent_byte_stream.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+namespace {
+void wait_for( EventFD& event )
+{
+  pollfd pfd { event.fd_num(), POLLIN, 0 };
+  if ( poll( &pfd, 1, 5000 ) != 1 ) {
+    throw runtime_error( "timed out waiting for ConcurrentByteStream wakeup" );
+  }
+}
+
+void single_thread_test()
+{
+  ConcurrentByteStream bs { 8 };
+
+  bs.writer().push( "hello" );
+  bs.writer().push( "world" );
+  if ( bs.writer().bytes_pushed() != 8 or bs.writer().available_capacity() != 0 ) {
+    throw runtime_error( "push() did not respect capacity" );
+  }
+
+  string got;
+  while ( bs.reader().bytes_buffered() ) {
+    const auto view = bs.reader().peek();
+    got += view;
+    bs.reader().pop( view.size() );
+  }
+  if ( got != "hellowor" ) {
+    throw runtime_error( "expected \"hellowor\", got \"" + got + "\"" );
+  }
+
+  bs.writer().close();
+  if ( not bs.reader().is_finished() or bs.reader().bytes_popped() != 8 ) {
+    throw runtime_error( "stream should be finished after close and full pop" );
+  }
+}
+
+void two_thread_test( uint64_t capacity, size_t input_len )
+{
+  const string data = [&] {
+    default_random_engine rd { 1234 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  ConcurrentByteStream bs { capacity, true };
+
+  thread producer( [&] {
+    default_random_engine rd { 5678 };
+    uniform_int_distribution<size_t> write_size { 1, 3000 };
+    string_view remaining = data;
+    while ( not remaining.empty() ) {
+      bs.writable_event().clear();
+      const auto before = bs.writer().bytes_pushed();
+      bs.writer().push( remaining.substr( 0, write_size( rd ) ) );
+      const auto written = bs.writer().bytes_pushed() - before;
+      if ( written == 0 and bs.writer().available_capacity() == 0 ) {
+        wait_for( bs.writable_event() );
+      }
+      remaining.remove_prefix( written );
+    }
+    bs.writer().close();
+  } );
+
+  string output;
+  output.reserve( data.size() );
+  try {
+    while ( not bs.reader().is_finished() ) {
+      bs.readable_event().clear();
+      if ( bs.reader().bytes_buffered() == 0 ) {
+        if ( bs.reader().is_finished() ) {
+          break;
+        }
+        wait_for( bs.readable_event() );
+        continue;
+      }
+      const auto view = bs.reader().peek().substr( 0, 1500 );
+      output += view;
+      bs.reader().pop( view.size() );
+    }
+  } catch ( ... ) {
+    bs.set_error();
+    producer.join();
+    throw;
+  }
+
+  producer.join();
+
+  if ( output != data ) {
+    throw runtime_error( "mismatch between data written and read across threads" );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    single_thread_test();
+    two_thread_test( 4096, 1e6 );
+    two_thread_test( 65536, 4e6 );
+    two_thread_test( 100, 1e5 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
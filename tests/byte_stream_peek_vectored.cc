@@ -0,0 +1,75 @@
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "vectored peek over coalesced small writes", 15 };
+
+      test.execute( PeekVectored { 10, "", 0 } );
+      test.execute( Push { "cat" } );
+      test.execute( Push { "dog" } );
+      test.execute( Push { "bird" } );
+      test.execute( PeekVectored { 100, "catdogbird", 1 } );
+      test.execute( PeekVectored { 5, "catdo", 1 } );
+
+      test.execute( Pop { 4 } );
+      test.execute( PeekVectored { 100, "ogbird", 1 } );
+      test.execute( PeekVectored { 0, "", 0 } );
+      test.execute( BytesBuffered { 6 } );
+    }
+
+    {
+      const string cat( 1500, 'c' );
+      const string dog( 1500, 'd' );
+      const string bird( 2000, 'b' );
+      ByteStreamTestHarness test { "vectored peek over chunks", 15000 };
+
+      test.execute( PeekVectored { 10, "", 0 } );
+      test.execute( Push { cat } );
+      test.execute( Push { dog } );
+      test.execute( Push { bird } );
+      test.execute( PeekVectored { 10000, cat + dog + bird, 3 } );
+      test.execute( PeekVectored { 1501, cat + "d", 2 } );
+      test.execute( PeekVectored { 3000, cat + dog, 2 } );
+
+      test.execute( Pop { 1501 } );
+      test.execute( PeekVectored { 10000, dog.substr( 1 ) + bird, 2 } );
+      test.execute( PeekVectored { 1, "d", 1 } );
+      test.execute( PeekVectored { 0, "", 0 } );
+      test.execute( BytesBuffered { 3499 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "vectored peek over small ring", 4, ByteStream::Storage::Ring };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "defg" } );
+      test.execute( PeekVectored { 4, "defg", 2 } );
+      test.execute( PeekVectored { 1, "d", 1 } );
+      test.execute( Pop { 1 } );
+      test.execute( PeekVectored { 10, "efg", 1 } );
+    }
+
+    {
+      const string data( 5000, 'r' );
+      ByteStreamTestHarness test { "vectored peek over mirrored ring", 8192, ByteStream::Storage::Ring };
+
+      test.execute( Push { data } );
+      test.execute( Pop { 4000 } );
+      test.execute( Push { data } );
+      test.execute( PeekVectored { 10000, data.substr( 0, 1000 ) + data, 1 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
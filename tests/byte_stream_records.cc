@@ -0,0 +1,87 @@
+#include "byte_stream.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+string header( uint32_t len )
+{
+  string ret;
+  for ( int shift = 24; shift >= 0; shift -= 8 ) {
+    ret += static_cast<char>( ( len >> shift ) & 0xff );
+  }
+  return ret;
+}
+
+void expect_incomplete( const Reader& reader, uint64_t expected_needed )
+{
+  string scratch;
+  uint64_t needed = 0;
+  if ( peek_record( reader, scratch, needed ).has_value() ) {
+    throw runtime_error( "peek_record() returned a record that is not fully buffered" );
+  }
+  if ( needed != expected_needed ) {
+    throw runtime_error( "expected " + to_string( expected_needed ) + " more bytes needed, got "
+                         + to_string( needed ) );
+  }
+}
+
+void expect_record( Reader& reader, const string& payload, bool contiguous )
+{
+  string scratch;
+  uint64_t needed = 1;
+  const auto record = peek_record( reader, scratch, needed );
+  if ( not record.has_value() or *record != payload or needed != 0 ) {
+    throw runtime_error( "peek_record() did not return \"" + payload + "\"" );
+  }
+  if ( contiguous != ( record->data() != scratch.data() ) ) {
+    throw runtime_error( contiguous ? "contiguous record was copied" : "split record was not assembled" );
+  }
+  reader.pop( RECORD_HEADER_SIZE + record->size() );
+}
+
+void records_test( ByteStream::Storage storage )
+{
+  ByteStream bs { 10000, storage };
+
+  expect_incomplete( bs.reader(), RECORD_HEADER_SIZE );
+  bs.writer().push( header( 5 ).substr( 0, 2 ) );
+  expect_incomplete( bs.reader(), 2 );
+  bs.writer().push( header( 5 ).substr( 2 ) + "hel" );
+  expect_incomplete( bs.reader(), 2 );
+  bs.writer().push( "lo" + header( 0 ) + header( 3 ) + "abc" );
+  expect_record( bs.reader(), "hello", true );
+  expect_record( bs.reader(), "", true );
+  expect_record( bs.reader(), "abc", true );
+  expect_incomplete( bs.reader(), RECORD_HEADER_SIZE );
+
+  // A record too large to be coalesced spans two chunks in Chunked mode
+  const string big( 3000, 'x' );
+  bs.writer().push( header( 6000 ) + big );
+  expect_incomplete( bs.reader(), 3000 );
+  bs.writer().push( big );
+  expect_record( bs.reader(), big + big, storage != ByteStream::Storage::Chunked );
+  if ( bs.reader().bytes_buffered() != 0 ) {
+    throw runtime_error( "stream should be empty after popping every record" );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    records_test( ByteStream::Storage::Chunked );
+    records_test( ByteStream::Storage::Ring );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#include "byte_stream_test_harness.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::Chunked, ByteStream::Storage::Ring } ) {
+      {
+        ByteStreamTestHarness test { "reserve-commit", 8, storage };
+
+        test.execute( ReserveAndCommit { 5, "cat", 5 } );
+        test.execute( BytesPushed { 3 } );
+        test.execute( BytesBuffered { 3 } );
+        test.execute( AvailableCapacity { 5 } );
+        test.execute( Peek { "cat" } );
+
+        test.execute( ReserveAndCommit { 100, "dogfish", 5 } );
+        test.execute( BytesPushed { 8 } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( Peek { "catdogfi" } );
+        test.execute( ReserveAndCommit { 100, "", 0 } );
+
+        test.execute( Pop { 6 } );
+        test.execute( ReserveAndCommit { 6, "bird", 6 } );
+        test.execute( Push { "s" } );
+        test.execute( Peek { "fibirds" } );
+        test.execute( BytesPushed { 13 } );
+        test.execute( BytesPopped { 6 } );
+      }
+
+      {
+        ByteStreamTestHarness test { "reserve-commit-nothing", 4, storage };
+
+        test.execute( ReserveAndCommit { 4, "", 4 } );
+        test.execute( BufferEmpty { true } );
+        test.execute( Close {} );
+        test.execute( ReserveAndCommit { 4, "", 0 } );
+        test.execute( IsFinished { true } );
+      }
+    }
+
+    {
+      // Chunked storage hands out pooled blocks, never one string sized to the whole capacity
+      constexpr uint64_t block = ChunkPool::BLOCK_SIZE;
+      constexpr uint64_t most = ByteStream::MAX_RESERVED_BLOCKS * block;
+      ByteStreamTestHarness test { "reserve-commit-blocks", 1000000, ByteStream::Storage::Chunked };
+
+      const string data( block + 10, 'x' );
+      test.execute( ReserveAndCommit { 1000000, data, most } );
+      test.execute( BytesBuffered { block + 10 } );
+      test.execute( PeekOnce { string( block, 'x' ) } );
+      test.execute( Pop { block } );
+      test.execute( Peek { string( 10, 'x' ) } );
+      test.execute( ReserveAndCommit { block + 1, "tail", block + 1 } );
+      test.execute( Peek { string( 10, 'x' ) + "tail" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    constexpr auto ring = ByteStream::Storage::Ring;
+
+    {
+      ByteStreamTestHarness test { "ring small wraparound", 4, ring };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 2 } );
+      test.execute( Push { "defgh" } );
+
+      test.execute( BytesPushed { 6 } );
+      test.execute( BytesPopped { 2 } );
+      test.execute( BytesBuffered { 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "cdef" } );
+
+      test.execute( Pop { 3 } );
+      test.execute( Push { "ghi" } );
+      test.execute( Peek { "fghi" } );
+
+      test.execute( Close {} );
+      test.execute( ReadAll { "fghi" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      const string first( 3000, 'x' );
+      const string second( 3000, 'y' );
+      const string third( 2000, 'z' );
+      ByteStreamTestHarness test { "ring peek spans wraparound", 4096, ring };
+
+      test.execute( Push { first } );
+      test.execute( Push { second } );
+      test.execute( Peek { first + second.substr( 0, 1096 ) } );
+      test.execute( Pop { 3000 } );
+      test.execute( Push { third } );
+
+      test.execute( BytesBuffered { 3096 } );
+      test.execute( PeekOnce { second.substr( 0, 1096 ) + third } );
+
+      test.execute( Pop { 1096 } );
+      test.execute( PeekOnce { third } );
+      test.execute( Close {} );
+      test.execute( IsFinished { false } );
+      test.execute( ReadAll { third } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ByteStreamTestHarness test { "ring zero capacity", 0, ring };
+
+      test.execute( Push { "cat" } );
+      test.execute( BytesPushed { 0 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( Close {} );
+      test.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "many 1-byte writes share pooled blocks", 20000 };
+
+      string data;
+      for ( size_t i = 0; i < 10000; ++i ) {
+        const string byte( 1, static_cast<char>( 'a' + i % 26 ) );
+        test.execute( Push { byte } );
+        data += byte;
+      }
+
+      test.execute( BytesBuffered { 10000 } );
+      test.execute( PeekVectored { 20000, data, 3 } );
+      test.execute( Pop { 4097 } );
+      test.execute( PeekVectored { 20000, data.substr( 4097 ), 2 } );
+      test.execute( Close {} );
+      test.execute( ReadAll { data.substr( 4097 ) } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      const string big( 2000, 'x' );
+      ByteStreamTestHarness test { "small write after a large one", 5000 };
+
+      test.execute( Push { big } );
+      test.execute( Push { "yz" } );
+      test.execute( PeekVectored { 5000, big + "yz", 2 } );
+      test.execute( Pop { 2000 } );
+      test.execute( Push { "w" } );
+      test.execute( Peek { "yzw" } );
+      test.execute( Pop { 3 } );
+      test.execute( BufferEmpty { true } );
+      test.execute( Push { "again" } );
+      test.execute( Peek { "again" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "small reserve/commit is coalesced", 100 };
+
+      test.execute( Push { "head" } );
+      test.execute( ReserveAndCommit { 50, "tail", 50 } );
+      test.execute( PeekVectored { 100, "headtail", 1 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include "byte_stream.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+string random_data( size_t len, unsigned seed )
+{
+  default_random_engine rd { seed };
+  uniform_int_distribution<char> ud;
+  string ret;
+  ret.reserve( len );
+  for ( size_t i = 0; i < len; ++i ) {
+    ret += ud( rd );
+  }
+  return ret;
+}
+
+// Push and pop random amounts through a spilling stream and check every byte comes back out in order
+void spill_test( uint64_t capacity, uint64_t memory_limit, size_t input_len )
+{
+  const string data = random_data( input_len, 1234 );
+
+  ByteStream bs { capacity, ByteStream::Storage::Spill, memory_limit };
+  default_random_engine rd { 5678 };
+  uniform_int_distribution<size_t> write_size { 1, capacity };
+  uniform_int_distribution<size_t> read_size { 1, capacity / 2 };
+
+  string_view remaining = data;
+  string output;
+  output.reserve( data.size() );
+  while ( not bs.reader().is_finished() ) {
+    if ( not remaining.empty() ) {
+      const auto before = bs.writer().bytes_pushed();
+      bs.writer().push( string { remaining.substr( 0, write_size( rd ) ) } );
+      remaining.remove_prefix( bs.writer().bytes_pushed() - before );
+    } else if ( not bs.writer().is_closed() ) {
+      bs.writer().close();
+    }
+
+    const auto view = bs.reader().peek().substr( 0, read_size( rd ) );
+    output += view;
+    bs.reader().pop( view.size() );
+  }
+
+  if ( output != data ) {
+    throw runtime_error( "mismatch between data pushed to and popped from a spilling ByteStream (capacity="
+                         + to_string( capacity ) + ", memory_limit=" + to_string( memory_limit ) + ")" );
+  }
+}
+
+// Fill the stream far past the memory limit, then make sure the evicted middle reads back intact
+void fill_then_drain_test()
+{
+  constexpr uint64_t capacity = 1 << 20;
+  const string data = random_data( capacity, 42 );
+
+  ByteStream bs { capacity, ByteStream::Storage::Spill, 64 * 1024 };
+  for ( size_t i = 0; i < data.size(); i += 1000 ) {
+    bs.writer().push( data.substr( i, 1000 ) );
+  }
+  bs.writer().close();
+
+  if ( bs.reader().bytes_buffered() != capacity ) {
+    throw runtime_error( "spilling ByteStream did not accept a full capacity of data" );
+  }
+
+  const ByteStream copy = bs;
+  if ( copy.reader().peek() != data ) {
+    throw runtime_error( "copy of a spilling ByteStream does not match" );
+  }
+
+  string output;
+  while ( not bs.reader().is_finished() ) {
+    const auto view = bs.reader().peek().substr( 0, 4000 );
+    output += view;
+    bs.reader().pop( view.size() );
+  }
+  if ( output != data ) {
+    throw runtime_error( "evicted bytes were not read back intact" );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    spill_test( 1 << 20, 64 * 1024, 8e6 );
+    spill_test( 65536, 8192, 2e6 );
+    spill_test( 100, 0, 1e5 );
+    spill_test( 300000, 1, 2e6 );
+    fill_then_drain_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include "byte_stream.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+string drain( Reader& reader )
+{
+  string out;
+  read( reader, reader.bytes_buffered(), out );
+  return out;
+}
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+void splice_test( ByteStream::Storage from_storage, ByteStream::Storage to_storage, const string& name )
+{
+  ByteStream from { 20, from_storage };
+  ByteStream to { 10, to_storage };
+
+  from.writer().push( "abc" );
+  from.writer().push( "defgh" );
+  from.writer().push( "ijklmno" );
+  from.reader().pop( 1 );
+
+  // Limited by max_len, splitting the middle chunk
+  expect( splice( from.reader(), to.writer(), 4 ) == 4, name + ": first splice should move 4 bytes" );
+  expect( from.reader().bytes_popped() == 5, name + ": bytes_popped after first splice" );
+  expect( to.writer().bytes_pushed() == 4, name + ": bytes_pushed after first splice" );
+
+  // Limited by the destination's available capacity
+  expect( splice( from.reader(), to.writer(), 100 ) == 6, name + ": second splice should move 6 bytes" );
+  expect( to.writer().available_capacity() == 0, name + ": destination should be full" );
+  expect( splice( from.reader(), to.writer(), 100 ) == 0, name + ": splice into a full stream should move 0" );
+  expect( drain( to.reader() ) == "bcdefghijk", name + ": destination contents" );
+
+  // Whole remaining chunk, then nothing left to move
+  expect( splice( from.reader(), to.writer(), 100 ) == 4, name + ": third splice should move 4 bytes" );
+  expect( from.reader().bytes_buffered() == 0, name + ": source should be empty" );
+  expect( from.reader().bytes_popped() == from.writer().bytes_pushed(), name + ": source counters" );
+  expect( to.writer().bytes_pushed() == 14, name + ": destination bytes_pushed" );
+  expect( drain( to.reader() ) == "lmno", name + ": destination tail contents" );
+
+  // Nothing moves into a closed stream
+  from.writer().push( "pq" );
+  to.writer().close();
+  expect( splice( from.reader(), to.writer(), 100 ) == 0, name + ": splice into a closed stream should move 0" );
+  expect( from.reader().bytes_buffered() == 2, name + ": source untouched after failed splice" );
+}
+} // namespace
+
+int main()
+{
+  try {
+    using enum ByteStream::Storage;
+    splice_test( Chunked, Chunked, "chunked->chunked" );
+    splice_test( Chunked, Ring, "chunked->ring" );
+    splice_test( Ring, Chunked, "ring->chunked" );
+    splice_test( Ring, Ring, "ring->ring" );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
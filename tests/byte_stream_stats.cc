@@ -0,0 +1,81 @@
+#include "byte_stream.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono_literals;
+
+namespace {
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+void counters_test( ByteStream::Storage storage )
+{
+  ByteStream bs { 10, storage };
+  bs.writer().push( "abcd" );
+  bs.writer().push( "efghijkl" );
+  bs.reader().pop( 6 );
+  bs.writer().push( "mn" );
+
+  const auto stats = bs.reader().stats();
+  if constexpr ( not ByteStreamStats::enabled ) {
+    expect( stats.peak_bytes_buffered == 0 and stats.chunks == 0 and stats.allocations == 0
+              and stats.time_full == 0ns and stats.time_empty == 0ns,
+            "statistics should stay zero when compiled out" );
+    return;
+  }
+
+  expect( stats.peak_bytes_buffered == 10, "expected peak of 10 bytes buffered" );
+  expect( stats.chunks == 3 and stats.chunk_bytes == 12, "expected 3 chunks carrying 12 bytes" );
+  expect( stats.mean_chunk_size() == 4, "expected a mean chunk size of 4" );
+  // One ring, or one pooled block holding all three small writes
+  expect( stats.allocations == 1, "unexpected number of allocations" );
+}
+
+void stall_time_test()
+{
+  if constexpr ( not ByteStreamStats::enabled ) {
+    return;
+  }
+
+  ByteStream bs { 4, ByteStream::Storage::Ring };
+  this_thread::sleep_for( 20ms );
+  bs.writer().push( "abcd" );
+  this_thread::sleep_for( 20ms );
+  bs.reader().pop( 4 );
+
+  const auto stats = bs.writer().stats();
+  expect( stats.time_empty >= 20ms, "reader wait before the first byte was not counted as empty time" );
+  expect( stats.time_full >= 20ms, "time at zero available capacity was not counted as full time" );
+
+  // Once closed, an empty stream is no longer waiting for its writer
+  bs.writer().close();
+  const auto closed = bs.writer().stats().time_empty;
+  this_thread::sleep_for( 10ms );
+  expect( bs.writer().stats().time_empty == closed, "closed stream kept accumulating empty time" );
+}
+} // namespace
+
+int main()
+{
+  try {
+    counters_test( ByteStream::Storage::Chunked );
+    counters_test( ByteStream::Storage::Ring );
+    stall_time_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
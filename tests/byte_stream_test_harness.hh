@@ -4,6 +4,8 @@
 #include "common.hh"
 #include "helpers.hh"
 
+#include <algorithm>
+#include <span>
 #include <utility>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -12,6 +14,19 @@ static_assert( sizeof( Reader ) == sizeof( ByteStream ),
 static_assert( sizeof( Writer ) == sizeof( ByteStream ),
                "Please add member variables to the ByteStream base, not the ByteStream Writer." );
 
+inline std::string storage_name( ByteStream::Storage storage )
+{
+  switch ( storage ) {
+    case ByteStream::Storage::Chunked:
+      return "chunked";
+    case ByteStream::Storage::Ring:
+      return "ring";
+    case ByteStream::Storage::Spill:
+      return "spill";
+  }
+  return "unknown";
+}
+
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
@@ -19,6 +34,12 @@ public:
     : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
   {}
 
+  ByteStreamTestHarness( std::string test_name, uint64_t capacity, ByteStream::Storage storage )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity ) + ", storage=" + storage_name( storage ),
+                   ByteStream { capacity, storage } )
+  {}
+
   size_t peek_size() { return object().reader().peek().size(); }
 };
 
@@ -34,6 +55,47 @@ struct Push : public Action<ByteStream>
   constexpr std::string obj() const override { return "Writer"; }
 };
 
+struct ReserveAndCommit : public Action<ByteStream>
+{
+  uint64_t reserve_len_;
+  std::string data_;
+  uint64_t expected_reserved_;
+
+  ReserveAndCommit( uint64_t reserve_len, std::string data, uint64_t expected_reserved )
+    : reserve_len_( reserve_len ), data_( move( data ) ), expected_reserved_( expected_reserved )
+  {}
+
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( reserve_len_ ) + " ), write \"" + pretty_print( data_ )
+           + "\" and commit";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::vector<std::span<char>> spans;
+    bs.writer().reserve( reserve_len_, spans );
+
+    uint64_t reserved = 0;
+    for ( const auto& region : spans ) {
+      reserved += region.size();
+    }
+    if ( reserved != expected_reserved_ ) {
+      throw ExpectationViolation { "bytes reserved", expected_reserved_, reserved };
+    }
+
+    std::string_view remaining = data_;
+    for ( const auto& region : spans ) {
+      const auto piece = remaining.substr( 0, region.size() );
+      std::copy( piece.begin(), piece.end(), region.begin() );
+      remaining.remove_prefix( piece.size() );
+    }
+    bs.writer().commit( data_.size() - remaining.size() );
+  }
+
+  constexpr std::string obj() const override { return "Writer"; }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -119,6 +181,45 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekVectored : public Expectation<ByteStream>
+{
+  uint64_t max_len_;
+  std::string output_;
+  size_t views_;
+
+  PeekVectored( uint64_t max_len, std::string output, size_t views )
+    : max_len_( max_len ), output_( move( output ) ), views_( views )
+  {}
+
+  std::string description() const override
+  {
+    return "peek( " + std::to_string( max_len_ ) + " ) gives \"" + pretty_print( output_ ) + "\" in "
+           + std::to_string( views_ ) + " view(s)";
+  }
+
+  void execute( const ByteStream& bs ) const override
+  {
+    std::vector<std::string_view> views { "stale" };
+    bs.reader().peek( max_len_, views );
+    std::string got;
+    for ( const auto& view : views ) {
+      if ( view.empty() ) {
+        throw ExpectationViolation { "peek() returned an empty view in the list" };
+      }
+      got += view;
+    }
+    if ( got != output_ ) {
+      throw ExpectationViolation { "peek() should have returned \"" + pretty_print( output_ )
+                                   + "\", but instead returned \"" + pretty_print( got ) + "\"" };
+    }
+    if ( views.size() != views_ ) {
+      throw ExpectationViolation { "number of views", views_, views.size() };
+    }
+  }
+
+  constexpr std::string obj() const override { return "Reader"; }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
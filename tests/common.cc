@@ -90,6 +90,9 @@ string to_string( const TCPSenderMessage& msg )
   if ( msg.RST ) {
     o << " +RST";
   }
+  if ( msg.timestamp.has_value() ) {
+    o << " TS=" << *msg.timestamp;
+  }
   o << ")";
   return o.str();
 }
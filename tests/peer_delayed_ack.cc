@@ -0,0 +1,134 @@
+#include "random.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+namespace {
+struct Endpoint
+{
+  TCPPeer peer;
+  deque<TCPMessage> sent {};
+
+  auto transmit()
+  {
+    // TCPPeer lends out its messages only for the duration of the call, so keep copies
+    return [this]( const TCPMessage& msg ) {
+      sent.push_back( { .sender = TCPSenderMessage { msg.sender.get() },
+                        .receiver = TCPReceiverMessage { msg.receiver.get() } } );
+    };
+  }
+};
+
+// No time passes between segments here, so RACK is off: it would take the reordering below for a loss
+TCPConfig make_config( Wrap32 isn )
+{
+  TCPConfig cfg;
+  cfg.isn = isn;
+  cfg.recv_capacity = 4000;
+  cfg.mss = 0;
+  cfg.rack = false;
+  return cfg;
+}
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+void deliver( TCPMessage msg, Endpoint& to )
+{
+  to.peer.receive( std::move( msg ), to.transmit() );
+}
+
+void deliver_next( Endpoint& from, Endpoint& to )
+{
+  expect( not from.sent.empty(), "expected a segment to deliver" );
+  TCPMessage msg = std::move( from.sent.front() );
+  from.sent.pop_front();
+  deliver( std::move( msg ), to );
+}
+
+// The only segment `from` sent is a pure ACK of `ackno` with the given window; deliver it to `to`
+void expect_ack( Endpoint& from, Endpoint& to, Wrap32 ackno, uint16_t window, const string& what )
+{
+  expect( from.sent.size() == 1, what + ": expected exactly one ACK, got " + to_string( from.sent.size() ) );
+  const TCPMessage& msg = from.sent.front();
+  expect( msg.sender->sequence_length() == 0 and msg.receiver->ackno == ackno
+            and msg.receiver->window_size == window,
+          what + ": unexpected ACK" );
+  deliver_next( from, to );
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+    const Wrap32 isn( rd() );
+    Endpoint client { TCPPeer { make_config( isn ) } };
+    const Wrap32 server_isn( rd() );
+    Endpoint server { TCPPeer { make_config( server_isn ) } };
+
+    // Handshake: the SYNs are acknowledged at once
+    client.peer.push( client.transmit() );
+    deliver_next( client, server );
+    deliver_next( server, client );
+    deliver_next( client, server );
+    expect( server.sent.empty(), "the final ACK of the handshake needs no reply" );
+
+    // Every second full-sized segment is acknowledged at once
+    client.peer.outbound_writer().push( string( 3000, 'x' ) );
+    client.peer.push( client.transmit() );
+    expect( client.sent.size() == 3, "expected three segments" );
+    deliver_next( client, server );
+    expect( server.sent.empty(), "the first segment's ACK is delayed" );
+    deliver_next( client, server );
+    expect_ack( server, client, isn + 2001, 2000, "second full-sized segment" );
+
+    // A lone segment is acknowledged when the timer expires
+    deliver_next( client, server );
+    server.peer.tick( 39, server.transmit() );
+    expect( server.sent.empty(), "the ACK waits for the timer" );
+    server.peer.tick( 1, server.transmit() );
+    expect_ack( server, client, isn + 3001, 1000, "delayed-ACK timer" );
+
+    // The application reads everything: the window update goes out on the next tick
+    server.peer.inbound_reader().pop( 3000 );
+    server.peer.tick( 0, server.transmit() );
+    expect_ack( server, client, isn + 3001, 4000, "window update" );
+
+    // Out-of-order data, and the segment that fills the gap, are acknowledged at once
+    client.peer.outbound_writer().push( string( 2000, 'y' ) );
+    client.peer.push( client.transmit() );
+    expect( client.sent.size() == 2, "expected two segments" );
+    TCPMessage first = std::move( client.sent.front() );
+    client.sent.pop_front();
+    deliver_next( client, server );
+    expect_ack( server, client, isn + 3001, 4000, "out-of-order segment" );
+    deliver( std::move( first ), server );
+    expect_ack( server, client, isn + 5001, 2000, "gap-filling segment" );
+
+    // So is the FIN
+    client.peer.outbound_writer().close();
+    client.peer.push( client.transmit() );
+    deliver_next( client, server );
+    expect_ack( server, client, isn + 5002, 2000, "FIN" );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
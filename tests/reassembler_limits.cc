@@ -0,0 +1,127 @@
+#include "byte_stream.hh"
+#include "reassembler.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+void expect_pending( const Reassembler& r, uint64_t expected )
+{
+  if ( r.count_bytes_pending() != expected ) {
+    throw runtime_error( "expected " + to_string( expected ) + " bytes pending, got "
+                         + to_string( r.count_bytes_pending() ) );
+  }
+}
+
+string drain( Reassembler& r )
+{
+  string out;
+  read( r.reader(), r.reader().bytes_buffered(), out );
+  return out;
+}
+
+// Adjacent 1-byte fragments merge into a single fragment, so a tiny fragment limit still holds them all
+void coalescing_test()
+{
+  Reassembler r { ByteStream { 1000 }, Reassembler::Engine::Map, { .max_fragments = 2 } };
+
+  string expected = "a";
+  for ( uint64_t i = 1; i < 500; ++i ) {
+    const string byte( 1, static_cast<char>( 'a' + i % 26 ) );
+    expected += byte;
+    r.insert( i, byte, false );
+  }
+  expect_pending( r, 499 );
+
+  // Overlapping and bridging fragments merge too
+  r.insert( 600, "xyz", false );
+  r.insert( 598, "vwx", false );
+  r.insert( 601, "yzq", false );
+  expect_pending( r, 499 + 6 );
+
+  r.insert( 0, "a", false );
+  if ( drain( r ) != expected ) {
+    throw runtime_error( "coalesced fragments were not reassembled in order" );
+  }
+  expect_pending( r, 6 );
+}
+
+// Scattered 1-byte fragments beyond the limit are dropped, farthest first
+void drop_farthest_test()
+{
+  Reassembler r { ByteStream { 100000 }, Reassembler::Engine::Map, { .max_fragments = 10 } };
+
+  for ( uint64_t i = 50; i > 0; --i ) {
+    r.insert( 2 * i, "x", false );
+  }
+  expect_pending( r, 10 );
+
+  // The nearest fragments survive: filling the gaps below them releases exactly those bytes
+  for ( uint64_t i = 0; i < 10; ++i ) {
+    r.insert( 2 * i + 1, "y", false );
+  }
+  r.insert( 0, "z", false );
+  if ( drain( r ) != "zyxyxyxyxyxyxyxyxyxyx" ) {
+    throw runtime_error( "unexpected bytes after dropping distant fragments" );
+  }
+  expect_pending( r, 0 );
+
+  // The dropped bytes are simply accepted again when retransmitted
+  r.insert( 22, "retransmit", true );
+  r.insert( 21, "!", false );
+  if ( drain( r ) != "!retransmit" or not r.reader().is_finished() ) {
+    throw runtime_error( "retransmitted bytes were not accepted after being dropped" );
+  }
+}
+
+// The metadata budget caps the fragment count as well
+void metadata_limit_test()
+{
+  Reassembler r { ByteStream { 100000 }, Reassembler::Engine::Map, { .max_metadata_bytes = 1024 } };
+  for ( uint64_t i = 1; i <= 1000; ++i ) {
+    r.insert( 3 * i, "ab", false );
+  }
+  if ( r.count_bytes_pending() == 0 or r.count_bytes_pending() >= 2 * 1024 / 64 ) {
+    throw runtime_error( "metadata limit was not enforced: " + to_string( r.count_bytes_pending() )
+                         + " bytes pending" );
+  }
+}
+
+// Buffer space beyond the data counts against the metadata budget: prepending to a long fragment
+// reserves headroom in front of it for bytes that may still arrive
+void headroom_test()
+{
+  Reassembler r { ByteStream { 100000 }, Reassembler::Engine::Map, { .max_metadata_bytes = 4096 } };
+  r.insert( 10001, string( 10000, 'a' ), false );
+  expect_pending( r, 10000 );
+
+  r.insert( 10000, "b", false );
+  expect_pending( r, 0 );
+
+  r.insert( 0, string( 10000, 'c' ), false );
+  r.insert( 10000, "b" + string( 10000, 'a' ), true );
+  if ( drain( r ) != string( 10000, 'c' ) + "b" + string( 10000, 'a' ) or not r.reader().is_finished() ) {
+    throw runtime_error( "bytes dropped for their headroom were not accepted again" );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    coalescing_test();
+    drop_farthest_test();
+    metadata_limit_test();
+    headroom_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
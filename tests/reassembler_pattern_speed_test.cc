@@ -0,0 +1,329 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+// Count every heap allocation made by this program, so each run can report allocations per insert.
+namespace {
+uint64_t allocation_count = 0; // NOLINT(*-avoid-non-const-global-variables)
+} // namespace
+
+void* operator new( size_t size )
+{
+  ++allocation_count;
+  if ( void* ptr = malloc( size ? size : 1 ) ) { // NOLINT(*-no-malloc)
+    return ptr;
+  }
+  throw bad_alloc {};
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc)
+}
+
+void operator delete( void* ptr, size_t /* size */ ) noexcept
+{
+  free( ptr ); // NOLINT(*-no-malloc)
+}
+
+namespace {
+constexpr size_t STREAM_LEN = 8 * 1000 * 1000;
+
+// The receive window and segment size of a run
+struct Shape
+{
+  string_view name;
+  uint64_t capacity;
+  uint64_t segment_size;
+  ReassemblerLimits limits;
+};
+
+constexpr Shape TYPICAL { "", 64000, 1000, {} };
+
+// A window of thousands of small segments, where any per-insert cost proportional to the bytes already held
+// shows up at once. The fragment limits are lifted so that nothing is dropped (nothing is retransmitted here).
+constexpr Shape LARGE_WINDOW { ", 2 MB window",
+                               2'000'000,
+                               100,
+                               { .max_fragments = UINT64_MAX, .max_metadata_bytes = UINT64_MAX } };
+
+struct Segment
+{
+  uint64_t first_index;
+  string data;
+  bool is_last;
+};
+
+// The segments of one connection, in arrival order
+using Arrivals = vector<Segment>;
+
+enum class Pattern : uint8_t
+{
+  InOrder,
+  RandomPermutation,
+  Reverse,
+  SingleByteHoles,
+  BurstLoss,
+  HeavyDuplication,
+  FinFirst,
+};
+
+string_view pattern_name( Pattern pattern )
+{
+  switch ( pattern ) {
+    case Pattern::InOrder:
+      return "in order";
+    case Pattern::RandomPermutation:
+      return "random permutation";
+    case Pattern::Reverse:
+      return "reverse";
+    case Pattern::SingleByteHoles:
+      return "1-byte holes";
+    case Pattern::BurstLoss:
+      return "burst loss";
+    case Pattern::HeavyDuplication:
+      return "heavy duplication";
+    case Pattern::FinFirst:
+      return "FIN first";
+  }
+  return "unknown";
+}
+
+Segment make_segment( const string& data, uint64_t first_index, uint64_t len )
+{
+  return { first_index, data.substr( first_index, len ), first_index + len >= data.size() };
+}
+
+// Every pattern reorders segments only within one window of `shape.capacity` bytes, so (with the reader
+// draining after each insert) every segment fits in the Reassembler's available capacity.
+void add_window( const string& data,
+                 uint64_t window,
+                 Pattern pattern,
+                 const Shape& shape,
+                 default_random_engine& rd,
+                 Arrivals& out )
+{
+  const uint64_t segment_size = shape.segment_size;
+  const uint64_t window_end = min( window + shape.capacity, static_cast<uint64_t>( data.size() ) );
+  Arrivals segments;
+  for ( uint64_t i = window; i < window_end; i += segment_size ) {
+    segments.push_back( make_segment( data, i, min( segment_size, window_end - i ) ) );
+  }
+
+  switch ( pattern ) {
+    case Pattern::InOrder:
+      break;
+
+    case Pattern::RandomPermutation:
+      shuffle( segments.begin(), segments.end(), rd );
+      break;
+
+    case Pattern::Reverse:
+    case Pattern::FinFirst:
+      reverse( segments.begin(), segments.end() );
+      if ( pattern == Pattern::FinFirst ) {
+        // Only the final segment jumps ahead; the rest arrive in order behind it
+        reverse( segments.begin() + 1, segments.end() );
+      }
+      break;
+
+    case Pattern::SingleByteHoles: {
+      // Each segment loses its first byte; the holes are filled last, from the back
+      Arrivals holes;
+      for ( auto& segment : segments ) {
+        holes.push_back( make_segment( data, segment.first_index, 1 ) );
+        segment = make_segment( data, segment.first_index + 1, segment.data.size() - 1 );
+      }
+      reverse( holes.begin(), holes.end() );
+      segments.insert( segments.end(), holes.begin(), holes.end() );
+      break;
+    }
+
+    case Pattern::BurstLoss: {
+      // The first quarter of the window is lost and retransmitted after the rest arrives
+      const auto burst_end = segments.begin() + static_cast<ptrdiff_t>( segments.size() / 4 );
+      rotate( segments.begin(), burst_end, segments.end() );
+      break;
+    }
+
+    case Pattern::HeavyDuplication: {
+      // Each segment is followed by three copies of random segments from the window (some not yet
+      // due, some already delivered), shifted by up to half a segment
+      Arrivals duplicated;
+      for ( const auto& segment : segments ) {
+        duplicated.push_back( segment );
+        for ( int copy = 0; copy < 3; ++copy ) {
+          const uint64_t base = segments[rd() % segments.size()].first_index;
+          const uint64_t start = min( base + rd() % ( segment_size / 2 ), window_end - 1 );
+          duplicated.push_back( make_segment( data, start, min( segment_size, window_end - start ) ) );
+        }
+      }
+      segments = move( duplicated );
+      break;
+    }
+  }
+
+  move( segments.begin(), segments.end(), back_inserter( out ) );
+}
+
+// FIN-first traffic is many short connections (one window each); every other pattern is one long one
+vector<Arrivals> make_connections( const string& data, Pattern pattern, const Shape& shape )
+{
+  default_random_engine rd { 2024 };
+  vector<Arrivals> connections;
+  if ( pattern == Pattern::FinFirst ) {
+    for ( uint64_t window = 0; window < data.size(); window += shape.capacity ) {
+      const string message = data.substr( window, shape.capacity );
+      connections.emplace_back();
+      add_window( message, 0, pattern, shape, rd, connections.back() );
+    }
+  } else {
+    connections.emplace_back();
+    for ( uint64_t window = 0; window < data.size(); window += shape.capacity ) {
+      add_window( data, window, pattern, shape, rd, connections.back() );
+    }
+  }
+  return connections;
+}
+
+struct RunResult
+{
+  duration<double> elapsed {};
+  uint64_t inserts {};
+  uint64_t peak_pending {};
+  uint64_t allocations {};
+  string output {};
+};
+
+// Feed every connection through a fresh Reassembler, draining its output after each insert.
+// Watching count_bytes_pending() can be slow (the map engine walks its fragments), so it is only
+// done on an untimed run.
+RunResult run( vector<Arrivals> connections, Reassembler::Engine engine, const Shape& shape, bool watch_pending )
+{
+  RunResult result;
+  result.output.reserve( STREAM_LEN );
+
+  const uint64_t allocations_before = allocation_count;
+  const auto start_time = steady_clock::now();
+  for ( auto& arrivals : connections ) {
+    Reassembler reassembler { ByteStream { shape.capacity, ByteStream::Storage::Ring }, engine, shape.limits };
+    for ( auto& segment : arrivals ) {
+      reassembler.insert( segment.first_index, move( segment.data ), segment.is_last );
+      ++result.inserts;
+      if ( watch_pending ) {
+        result.peak_pending = max( result.peak_pending, reassembler.count_bytes_pending() );
+      }
+
+      Reader& reader = reassembler.reader();
+      while ( reader.bytes_buffered() ) {
+        const string_view view = reader.peek();
+        result.output += view;
+        reader.pop( view.size() );
+      }
+    }
+
+    if ( not reassembler.reader().is_finished() ) {
+      throw runtime_error( "Reassembler did not close ByteStream when finished" );
+    }
+  }
+  result.elapsed = steady_clock::now() - start_time;
+  result.allocations = allocation_count - allocations_before;
+  return result;
+}
+
+void speed_test( const string& data, Pattern pattern, Reassembler::Engine engine, const Shape& shape = TYPICAL )
+{
+  const vector<Arrivals> connections = make_connections( data, pattern, shape );
+
+  const RunResult timed = run( connections, engine, shape, false );
+  const RunResult watched = run( connections, engine, shape, true );
+
+  for ( const auto* result : { &timed, &watched } ) {
+    if ( result->output != data ) {
+      throw runtime_error( "Mismatch between data written and read" );
+    }
+  }
+
+  const double seconds = timed.elapsed.count();
+  const double gigabits_per_second = 8 * static_cast<double>( data.size() ) / seconds / 1e9;
+  const double inserts_per_second = static_cast<double>( timed.inserts ) / seconds;
+  const double allocations_per_insert
+    = static_cast<double>( watched.allocations ) / static_cast<double>( watched.inserts );
+  const string_view engine_name = engine == Reassembler::Engine::Ring ? "ring" : "map";
+
+  cout << "Reassembler (" << engine_name << " engine, " << pattern_name( pattern ) << shape.name << ") reached "
+       << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s, " << inserts_per_second / 1e6
+       << " M inserts/s, peak pending " << watched.peak_pending << " bytes, " << allocations_per_insert
+       << " allocations/insert.\n";
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+  debug_output << "        Reassembler " << setw( 4 ) << engine_name << " " << setw( 18 ) << pattern_name( pattern )
+               << setw( 14 ) << shape.name << fixed << setprecision( 2 ) << setw( 8 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  const string data = [] {
+    default_random_engine rd { 1370 };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < STREAM_LEN; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  for ( const auto pattern : { Pattern::InOrder,
+                               Pattern::RandomPermutation,
+                               Pattern::Reverse,
+                               Pattern::SingleByteHoles,
+                               Pattern::BurstLoss,
+                               Pattern::HeavyDuplication,
+                               Pattern::FinFirst } ) {
+    for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Ring } ) {
+      speed_test( data, pattern, engine );
+    }
+  }
+
+  // Adversarial arrivals over a large window: reverse order keeps extending one fragment at its front, and
+  // filling the 1-byte holes from the back joins each small fragment to the large one behind it
+  const string two_windows = data.substr( 0, 2 * LARGE_WINDOW.capacity );
+  for ( const auto pattern : { Pattern::Reverse, Pattern::SingleByteHoles } ) {
+    for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Ring } ) {
+      speed_test( two_windows, pattern, engine, LARGE_WINDOW );
+    }
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
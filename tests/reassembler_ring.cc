@@ -0,0 +1,137 @@
+#include "byte_stream_test_harness.hh"
+#include "random.hh"
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+// Feed the same random (overlapping, out-of-order, partly out-of-window) inserts to both engines,
+// reading a random amount after each, and check they agree on output and pending bytes throughout.
+// Once the last substring has been sent, some inserts also carry bytes past the end of the stream.
+void differential_test( uint64_t capacity, ByteStream::Storage storage )
+{
+  auto rd = get_random_engine();
+  string data( 50000, 0 );
+  ranges::generate( data, [&] { return rd(); } );
+
+  Reassembler map_engine { ByteStream { capacity, storage }, Reassembler::Engine::Map };
+  Reassembler ring_engine { ByteStream { capacity, storage }, Reassembler::Engine::Ring };
+  string map_out;
+  string ring_out;
+  bool sent_last = false;
+
+  while ( not ring_engine.reader().is_finished() ) {
+    const uint64_t pushed = ring_engine.writer().bytes_pushed();
+    const uint64_t first = pushed - min<uint64_t>( 50, pushed ) + rd() % ( capacity + 100 );
+    const uint64_t len = rd() % 300;
+    if ( first < data.size() ) {
+      string segment = data.substr( first, len );
+      const bool last = first + segment.size() == data.size();
+      if ( sent_last and last ) {
+        segment += string( rd() % 20, '!' );
+      }
+      map_engine.insert( first, segment, last and not sent_last );
+      ring_engine.insert( first, segment, last and not sent_last );
+      sent_last = sent_last or last;
+    } else if ( sent_last ) {
+      map_engine.insert( first, string( len, '!' ), false );
+      ring_engine.insert( first, string( len, '!' ), false );
+    }
+
+    if ( map_engine.count_bytes_pending() != ring_engine.count_bytes_pending() ) {
+      throw runtime_error( "engines disagree on count_bytes_pending(): "
+                           + to_string( map_engine.count_bytes_pending() ) + " vs "
+                           + to_string( ring_engine.count_bytes_pending() ) );
+    }
+
+    const uint64_t to_read = rd() % capacity;
+    string chunk;
+    read( map_engine.reader(), to_read, chunk );
+    map_out += chunk;
+    read( ring_engine.reader(), to_read, chunk );
+    ring_out += chunk;
+    if ( map_out != ring_out ) {
+      throw runtime_error( "engines disagree on reassembled output" );
+    }
+  }
+
+  if ( ring_out != data or not map_engine.reader().is_finished() ) {
+    throw runtime_error( "ring engine did not reassemble the stream" );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    constexpr auto ring = Reassembler::Engine::Ring;
+
+    {
+      ReassemblerTestHarness test { "ring engine holes", 8, ring };
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( Insert { "fgh", 5 } );
+      test.execute( BytesPending { 5 } );
+      test.execute( Insert { "defgh", 3 } );
+      test.execute( BytesPending { 6 } );
+      test.execute( Insert { "ab", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( BytesPushed { 8 } );
+
+      // Bytes past the available capacity are discarded
+      test.execute( Insert { "jk", 9 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll { "abcdefgh" } );
+    }
+
+    {
+      ReassemblerTestHarness test { "ring engine wraps around", 6, ring };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( Insert { "ghij", 6 } );
+      test.execute( BytesPending { 4 } );
+      test.execute( Insert { "ef", 4 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( Insert { "", 10 }.is_last() );
+      test.execute( ReadAll { "efghij" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "ring engine last substring first", 100, ring };
+
+      test.execute( Insert { "z", 25 }.is_last() );
+      test.execute( Insert { "abcdefghijklmnopqrstuvwxy", 0 } );
+      test.execute( ReadAll { "abcdefghijklmnopqrstuvwxyz" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      ReassemblerTestHarness test { "ring engine ignores bytes past the end", 100, ring };
+
+      test.execute( Insert { "abc", 0 }.is_last() );
+      test.execute( IsClosed { true } );
+      test.execute( Insert { "xy", 5 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( Insert { "de", 3 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( ReadAll { "abc" } );
+      test.execute( IsFinished { true } );
+    }
+
+    differential_test( 1000, ByteStream::Storage::Chunked );
+    differential_test( 4096, ByteStream::Storage::Ring );
+    differential_test( 65, ByteStream::Storage::Chunked );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
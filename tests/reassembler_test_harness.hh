@@ -31,6 +31,13 @@ public:
                    { Reassembler { ByteStream { capacity } } } )
   {}
 
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, Reassembler::Engine engine )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ( engine == Reassembler::Engine::Ring ? ", engine=ring" : ", engine=map" ),
+                   { Reassembler { ByteStream { capacity }, engine } } )
+  {}
+
   template<std::derived_from<TestStep<ByteStream>> T>
   void execute( const T& test )
   {
@@ -7,6 +7,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<Reassembler>> T>
 struct DirectReassemblerTest : public TestStep<TCPReceiver>
@@ -37,10 +38,14 @@ struct DirectByteStreamTest : public TestStep<TCPReceiver>
 class TCPReceiverTestHarness : public TestHarness<TCPReceiver>
 {
 public:
-  TCPReceiverTestHarness( std::string test_name, uint64_t capacity )
+  TCPReceiverTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          bool window_scaling = false,
+                          bool sws_avoidance = false )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { TCPReceiver { Reassembler { ByteStream { capacity } } } } )
+                   "capacity=" + std::to_string( capacity ) + ( window_scaling ? ", window_scaling" : "" )
+                     + ( sws_avoidance ? ", sws_avoidance" : "" ),
+                   { TCPReceiver { Reassembler { ByteStream { capacity } }, window_scaling, {}, sws_avoidance } } )
   {}
 
   template<std::derived_from<TestStep<Reassembler>> T>
@@ -65,6 +70,20 @@ struct ExpectWindow : public ExpectNumber<TCPReceiver, uint16_t>
   uint16_t value( const TCPReceiver& rs ) const override { return rs.send().window_size; }
 };
 
+struct ExpectWindowScale : public ExpectNumber<TCPReceiver, std::optional<uint8_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_scale"; }
+  std::optional<uint8_t> value( const TCPReceiver& rs ) const override { return rs.send().window_scale; }
+};
+
+struct ExpectTimestampEcho : public ExpectNumber<TCPReceiver, std::optional<uint32_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timestamp_echo"; }
+  std::optional<uint32_t> value( const TCPReceiver& rs ) const override { return rs.send().timestamp_echo; }
+};
+
 struct ExpectAckno : public ExpectNumber<TCPReceiver, std::optional<Wrap32>>
 {
   using ExpectNumber::ExpectNumber;
@@ -72,6 +91,30 @@ struct ExpectAckno : public ExpectNumber<TCPReceiver, std::optional<Wrap32>>
   std::optional<Wrap32> value( const TCPReceiver& rs ) const override { return rs.send().ackno; }
 };
 
+struct ExpectSackBlocks : public Expectation<TCPReceiver>
+{
+  std::vector<std::pair<Wrap32, Wrap32>> blocks_;
+  explicit ExpectSackBlocks( std::vector<std::pair<Wrap32, Wrap32>> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "SACK blocks are [";
+    for ( const auto& [left, right] : blocks_ ) {
+      ss << " " << to_string( left ) << "-" << to_string( right );
+    }
+    ss << " ]";
+    return ss.str();
+  }
+
+  void execute( const TCPReceiver& rs ) const override
+  {
+    if ( rs.send().sack_blocks != blocks_ ) {
+      throw ExpectationViolation( "TCPReceiver reported unexpected SACK blocks" );
+    }
+  }
+};
+
 struct ExpectReset : public ExpectBool<TCPReceiver>
 {
   using ExpectBool::ExpectBool;
@@ -118,6 +161,7 @@ struct HasAckno : public ExpectBool<TCPReceiver>
 struct SegmentArrives : public Action<TCPReceiver>
 {
   TCPSenderMessage msg_ {};
+  bool window_scale_ {};
   HasAckno ackno_expected_ { true };
 
   SegmentArrives& with_syn()
@@ -132,6 +176,25 @@ struct SegmentArrives : public Action<TCPReceiver>
     return *this;
   }
 
+  SegmentArrives& with_sack_permitted()
+  {
+    msg_.SACK_permitted = true;
+    return *this;
+  }
+
+  // The receiver half of the same segment carried the window scale option
+  SegmentArrives& with_window_scale()
+  {
+    window_scale_ = true;
+    return *this;
+  }
+
+  SegmentArrives& with_timestamp( uint32_t tsval )
+  {
+    msg_.timestamp = tsval;
+    return *this;
+  }
+
   SegmentArrives& with_rst()
   {
     msg_.RST = true;
@@ -160,7 +223,8 @@ struct SegmentArrives : public Action<TCPReceiver>
 
   void execute( TCPReceiver& rs ) const override
   {
-    rs.receive( msg_ );
+    // After its SYN, every segment from the peer acknowledges ours
+    rs.receive( msg_, window_scale_, not msg_.SYN );
     ackno_expected_.execute( rs );
   }
 
@@ -168,6 +232,9 @@ struct SegmentArrives : public Action<TCPReceiver>
   {
     std::ostringstream ss;
     ss << "receive message: " << to_string( msg_ );
+    if ( window_scale_ ) {
+      ss << " +wscale";
+    }
 
     if ( ackno_expected_.value_ ) {
       ss << " with ackno expected";
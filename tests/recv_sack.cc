@@ -0,0 +1,126 @@
+#include "byte_stream_test_harness.hh"
+#include "helpers.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+// A receiver's SACK blocks survive a round trip through the TCP header's options
+void options_roundtrip_test( Wrap32 isn )
+{
+  TCPReceiver receiver { Reassembler { ByteStream { 100 } } };
+  receiver.receive( { .seqno = isn, .SYN = true, .SACK_permitted = true } );
+  receiver.receive( { .seqno = isn + 3, .payload = "cd" } );
+  receiver.receive( { .seqno = isn + 7, .payload = "gh" } );
+  receiver.receive( { .seqno = isn + 11, .payload = "kl" } );
+  receiver.receive( { .seqno = isn + 15, .payload = "op" } );
+  receiver.receive( { .seqno = isn + 19, .payload = "st" } );
+
+  TCPSegment seg;
+  seg.message.sender = TCPSenderMessage { .seqno = isn, .SYN = true, .SACK_permitted = true };
+  seg.message.receiver = receiver.send();
+  seg.compute_checksum( 0 );
+
+  TCPSegment parsed;
+  if ( not parse( parsed, serialize( seg ), 0 ) ) {
+    throw runtime_error( "segment with SACK options failed to parse" );
+  }
+  if ( not parsed.message.sender->SACK_permitted ) {
+    throw runtime_error( "SACK-permitted option was lost" );
+  }
+
+  // Only as many blocks as fit beside the other options are sent, most recent first
+  const auto& sent = seg.message.receiver->sack_blocks;
+  const auto& received = parsed.message.receiver->sack_blocks;
+  if ( received.empty() or received.size() > TCPReceiverMessage::MAX_SACK_BLOCKS
+       or not equal( received.begin(), received.end(), sent.begin() ) or received.front().first != isn + 19 ) {
+    throw runtime_error( "SACK blocks did not survive serialization: " + parsed.to_string() );
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "no SACK blocks unless permitted", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSackBlocks { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks report out-of-order data", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( ExpectSackBlocks { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "kl" ) );
+      // The block holding the most recent segment comes first
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 11 }, Wrap32 { isn + 13 } },
+                                         { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ij" ) );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 5 }, Wrap32 { isn + 13 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 13 } } );
+      test.execute( ExpectSackBlocks { {} } );
+      test.execute( ReadAll { "abcdefghijkl" } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "at most four SACK blocks", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      for ( uint32_t i = 0; i < 6; ++i ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 3 + 4 * i ).with_data( "x" ) );
+      }
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 23 }, Wrap32 { isn + 24 } },
+                                         { Wrap32 { isn + 3 }, Wrap32 { isn + 4 } },
+                                         { Wrap32 { isn + 7 }, Wrap32 { isn + 8 } },
+                                         { Wrap32 { isn + 11 }, Wrap32 { isn + 12 } } } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "D-SACK reports duplicate data", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_sack_permitted().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectSackBlocks { {} } );
+      // Already acknowledged: the first block lies below the ackno
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 1 }, Wrap32 { isn + 5 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ij" ) );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 9 }, Wrap32 { isn + 11 } } } } );
+      // Already SACKed: the first block lies inside the second
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ij" ) );
+      test.execute( ExpectSackBlocks { { { Wrap32 { isn + 9 }, Wrap32 { isn + 11 } },
+                                         { Wrap32 { isn + 9 }, Wrap32 { isn + 11 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 11 } } );
+      test.execute( ExpectSackBlocks { {} } );
+    }
+
+    options_roundtrip_test( Wrap32 { uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd ) } );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+#include "byte_stream_test_harness.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "window opens a full segment at a time", 4000, false, true };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { 4000 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 3000, 'x' ) ) );
+      test.execute( ExpectWindow { 1000 } );
+
+      // A slow reader: the window stays put until a whole segment's worth has been read
+      test.execute( Pop { 400 } );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( Pop { 500 } );
+      test.execute( ExpectWindow { 1000 } );
+      test.execute( Pop { 100 } );
+      test.execute( ExpectWindow { 2000 } );
+
+      // Arriving data never moves the right edge back
+      test.execute( SegmentArrives {}.with_seqno( isn + 3001 ).with_data( string( 300, 'y' ) ) );
+      test.execute( ExpectWindow { 1700 } );
+      test.execute( Pop { 999 } );
+      test.execute( ExpectWindow { 1700 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "small capacity opens by half", 600, false, true };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 600, 'x' ) ) );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 299 } );
+      test.execute( ExpectWindow { 0 } );
+      test.execute( Pop { 1 } );
+      test.execute( ExpectWindow { 300 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "without SWS avoidance every byte read opens the window", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 3000, 'x' ) ) );
+      test.execute( Pop { 400 } );
+      test.execute( ExpectWindow { 1400 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
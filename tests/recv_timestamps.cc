@@ -0,0 +1,102 @@
+#include "helpers.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+// TSval and TSecr survive a round trip through the TCP header's options; TSecr needs the ACK flag
+void options_roundtrip_test( Wrap32 isn )
+{
+  for ( const bool ack : { true, false } ) {
+    TCPSegment seg;
+    seg.message.sender = TCPSenderMessage { .seqno = isn, .payload = "hello", .timestamp = 4000000000 };
+    seg.message.receiver = TCPReceiverMessage { .ackno = ack ? optional { isn + 1 } : nullopt,
+                                                .window_size = 1000,
+                                                .sack_blocks = { { isn + 3, isn + 5 },
+                                                                 { isn + 7, isn + 9 },
+                                                                 { isn + 11, isn + 13 },
+                                                                 { isn + 15, isn + 17 } },
+                                                .timestamp_echo = 123 };
+    seg.compute_checksum( 0 );
+
+    TCPSegment parsed;
+    if ( not parse( parsed, serialize( seg ), 0 ) ) {
+      throw runtime_error( "segment with timestamps failed to parse" );
+    }
+    const TCPReceiverMessage& receiver = parsed.message.receiver;
+    const optional<uint32_t> expected_echo = ack ? optional<uint32_t> { 123 } : nullopt;
+    if ( parsed.message.sender->timestamp != 4000000000 or receiver.timestamp_echo != expected_echo
+         or parsed.message.sender->payload != "hello" ) {
+      throw runtime_error( "timestamps did not survive serialization: " + parsed.to_string() );
+    }
+    // Timestamps leave room for three SACK blocks
+    if ( ack and receiver.sack_blocks.size() != 3 ) {
+      throw runtime_error( "expected three SACK blocks beside the timestamps: " + parsed.to_string() );
+    }
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "echo the timestamp of the segment that advanced the ackno", 4000 };
+      test.execute( ExpectTimestampEcho { nullopt } );
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( 100 ).with_seqno( isn ) );
+      test.execute( ExpectTimestampEcho { 100 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ).with_timestamp( 105 ) );
+      test.execute( ExpectTimestampEcho { 105 } );
+      // Out of order: the ackno did not move, so neither does the echo
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ).with_timestamp( 110 ) );
+      test.execute( ExpectTimestampEcho { 105 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_timestamp( 108 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 7 } } );
+      test.execute( ExpectTimestampEcho { 108 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "PAWS drops segments with old timestamps", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_timestamp( UINT32_MAX - 10 ).with_seqno( isn ) );
+      // Timestamps compare modulo 2^32
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ).with_timestamp( 5 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 3 } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_timestamp( 4 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 3 } } );
+      test.execute( ExpectTimestampEcho { 5 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_timestamp( 5 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "no timestamps unless the SYN offered them", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "ab" ).with_timestamp( 100 ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 3 ).with_data( "cd" ).with_timestamp( 50 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 5 } } );
+      test.execute( ExpectTimestampEcho { nullopt } );
+    }
+
+    options_roundtrip_test( Wrap32 { uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd ) } );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
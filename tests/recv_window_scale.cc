@@ -0,0 +1,103 @@
+#include "byte_stream_test_harness.hh"
+#include "helpers.hh"
+#include "random.hh"
+#include "receiver_test_harness.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+// The window scale and MSS options are carried in SYN segments only
+void options_roundtrip_test( Wrap32 isn )
+{
+  for ( const bool syn : { true, false } ) {
+    TCPSegment seg;
+    seg.message.sender = TCPSenderMessage { .seqno = isn, .SYN = syn, .SACK_permitted = true };
+    seg.message.receiver
+      = TCPReceiverMessage { .ackno = isn + 1, .window_size = 1234, .window_scale = 7, .mss = 1460 };
+    seg.compute_checksum( 0 );
+
+    TCPSegment parsed;
+    if ( not parse( parsed, serialize( seg ), 0 ) ) {
+      throw runtime_error( "segment with window scale and MSS options failed to parse" );
+    }
+    const optional<uint8_t> expected = syn ? optional<uint8_t> { 7 } : nullopt;
+    const optional<uint16_t> expected_mss = syn ? optional<uint16_t> { 1460 } : nullopt;
+    if ( parsed.message.receiver->window_scale != expected or parsed.message.receiver->window_size != 1234
+         or parsed.message.receiver->mss != expected_mss or parsed.message.sender->SACK_permitted != syn ) {
+      throw runtime_error( "SYN options did not survive serialization: " + parsed.to_string() );
+    }
+  }
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "no window scaling unless offered", 1000000 };
+      test.execute( ExpectWindowScale { nullopt } );
+      test.execute( SegmentArrives {}.with_syn().with_window_scale().with_seqno( isn ) );
+      test.execute( ExpectWindowScale { nullopt } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "window scaling offered by both ends", 1000000, true };
+      // The smallest shift that fits the whole capacity in 16 bits
+      test.execute( ExpectWindowScale { 4 } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+      test.execute( SegmentArrives {}.with_syn().with_window_scale().with_seqno( isn ) );
+      test.execute( ExpectWindowScale { 4 } );
+      // The window on our SYN is not scaled; scaling starts once the peer has acknowledged it
+      test.execute( ExpectWindow { UINT16_MAX } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ) );
+      test.execute( ExpectWindow { 62500 } );
+      // The scaled window is rounded down
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectWindow { 62499 } );
+      test.execute( ReadAll { "abcd" } );
+      test.execute( ExpectWindow { 62500 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "no window scaling if the peer's SYN lacks it", 1000000, true };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindowScale { nullopt } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "small capacity needs no shift", 4000, true };
+      test.execute( SegmentArrives {}.with_syn().with_window_scale().with_seqno( isn ) );
+      test.execute( ExpectWindowScale { 0 } );
+      test.execute( ExpectWindow { 4000 } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "shift is capped at 14", uint64_t { 1 } << 32U, true };
+      test.execute( ExpectWindowScale { 14 } );
+    }
+
+    options_roundtrip_test( Wrap32 { uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd ) } );
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
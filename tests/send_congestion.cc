@@ -0,0 +1,66 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+      cfg.rack = false; // Tail loss probes would preempt the timeout under test
+
+      TCPSenderTestHarness test {
+        "Congestion window limits data in flight", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectCongestionWindow { 10000 } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 60000 } } );
+      // Slow start: the SYN's acknowledgment grows the window by one
+      test.execute( ExpectCongestionWindow { 10001 } );
+      test.execute( Push { string( 20000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 10001 } );
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 60000 } } );
+      test.execute( ExpectCongestionWindow { 11001 } );
+      test.execute( ExpectSeqnosInFlight { 11001 } );
+
+      // A timeout restarts slow start from one segment
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( Receive { { .ackno = isn + 12002, .window_size = 60000 } } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectSeqnosInFlight { 2000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControlAlgorithm::None;
+
+      TCPSenderTestHarness test { "No congestion control", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectCongestionWindow { UINT64_MAX } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 60000 } } );
+      test.execute( Push { string( 20000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 20000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
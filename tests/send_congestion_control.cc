@@ -0,0 +1,107 @@
+#include "congestion_control.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+constexpr uint64_t MSS = 1000;
+constexpr uint64_t RTT_MS = 100;
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( what );
+  }
+}
+
+// One round trip without loss: every segment of the window is acknowledged individually
+void round_trip( CongestionControl& cc, uint64_t& now_ms )
+{
+  now_ms += RTT_MS;
+  for ( uint64_t acked = 0, window = cc.cwnd(); acked < window; acked += MSS ) {
+    cc.on_ack( MSS, now_ms );
+  }
+}
+
+void new_reno_test()
+{
+  NewReno cc { MSS };
+  expect( cc.cwnd() == 10 * MSS and cc.in_slow_start(), "NewReno should start in slow start with 10 segments" );
+
+  uint64_t now_ms = 0;
+  round_trip( cc, now_ms );
+  expect( cc.cwnd() == 20 * MSS, "slow start should double the window each round trip" );
+
+  cc.on_loss( cc.cwnd(), now_ms );
+  expect( cc.cwnd() == 10 * MSS and cc.ssthresh() == 10 * MSS, "a loss should halve the window" );
+
+  round_trip( cc, now_ms );
+  expect( cc.cwnd() == 11 * MSS, "congestion avoidance should grow by one segment per round trip" );
+
+  cc.on_rto( 11 * MSS, now_ms );
+  expect( cc.cwnd() == MSS and cc.ssthresh() == 5500, "a timeout should collapse the window to one segment" );
+
+  cc.on_loss( MSS, now_ms );
+  expect( cc.ssthresh() == 2 * MSS, "ssthresh should never fall below two segments" );
+}
+
+void cubic_test()
+{
+  Cubic cc { MSS };
+  uint64_t now_ms = 0;
+  while ( cc.cwnd() < 100 * MSS ) {
+    cc.on_ack( MSS, now_ms );
+  }
+  cc.on_loss( cc.cwnd(), now_ms );
+  expect( cc.cwnd() == 70 * MSS, "CUBIC should reduce the window by 30% on loss" );
+
+  // The window should regain its pre-loss size after about K = cbrt(30 / C) seconds...
+  const uint64_t k_ms = 4217;
+  while ( now_ms < k_ms ) {
+    round_trip( cc, now_ms );
+  }
+  const uint64_t at_k = cc.cwnd();
+  expect( at_k > 95 * MSS and at_k < 105 * MSS, "CUBIC did not return to its plateau after K seconds" );
+
+  // ... grow only slowly around the plateau, then probe faster beyond it
+  while ( now_ms < 2 * k_ms ) {
+    round_trip( cc, now_ms );
+  }
+  const uint64_t probing = cc.cwnd();
+  expect( probing > at_k + 20 * MSS, "CUBIC did not probe beyond its plateau" );
+  expect( not cc.in_slow_start(), "CUBIC should stay in congestion avoidance" );
+
+  cc.on_rto( cc.cwnd(), now_ms );
+  expect( cc.cwnd() == MSS, "a timeout should collapse the window to one segment" );
+}
+
+void factory_test()
+{
+  expect( CongestionControl::make( CongestionControlAlgorithm::None, MSS ) == nullptr,
+          "no congestion control should mean no controller" );
+  expect( CongestionControl::make( CongestionControlAlgorithm::NewReno, MSS )->name() == "NewReno",
+          "factory did not build NewReno" );
+  expect( CongestionControl::make( CongestionControlAlgorithm::Cubic, MSS )->name() == "CUBIC",
+          "factory did not build CUBIC" );
+}
+} // namespace
+
+int main()
+{
+  try {
+    new_reno_test();
+    cubic_test();
+    factory_test();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+// Ack the SYN with a large window, then send five full segments
+void open_and_send( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  test.execute( Push {} );
+  test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+  test.execute( Receive { { .ackno = isn + 1, .window_size = 60000 } } );
+  test.execute( Push { string( 5000, 'x' ) } );
+  for ( uint32_t i = 0; i < 5; ++i ) {
+    test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+Receive ack( Wrap32 ackno )
+{
+  return Receive { { .ackno = ackno, .window_size = 60000 } };
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControlAlgorithm::None;
+
+      TCPSenderTestHarness test { "Third duplicate ACK retransmits", cfg, TCPSenderTestHarness::FullConfig {} };
+      open_and_send( test, isn );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // A partial ACK means the next segment was lost too
+      test.execute( ack( isn + 2001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( ack( isn + 5001 ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControlAlgorithm::None;
+
+      TCPSenderTestHarness test { "ACKs that change the window are not duplicates",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      open_and_send( test, isn );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 59000 } } );
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 58000 } } );
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 57000 } } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "Fast recovery halves cwnd and keeps the pipe full",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      open_and_send( test, isn );
+      test.execute( ack( isn + 1001 ) );
+      test.execute( ExpectCongestionWindow { 11001 } );
+      test.execute( Push { string( 3000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 5001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 6001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 7001 ) );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( ack( isn + 1001 ) );
+      }
+      // ssthresh = 7000 / 2 in flight; three segments have left the network
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectCongestionWindow { 3500 } );
+      test.execute( ExpectNoSegment {} );
+      // Each further duplicate inflates the window by a segment, letting new data out
+      for ( int i = 0; i < 4; ++i ) {
+        test.execute( ack( isn + 1001 ) );
+      }
+      test.execute( Push { string( 1000, 'z' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 8001 ) );
+      test.execute( ack( isn + 9001 ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 3500 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.dup_ack_threshold = 0;
+
+      TCPSenderTestHarness test { "Fast retransmit can be disabled", cfg, TCPSenderTestHarness::FullConfig {} };
+      open_and_send( test, isn );
+      for ( int i = 0; i < 5; ++i ) {
+        test.execute( ack( isn + 1 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "MSS option sets the segment size", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( ExpectMSS { 1000 } );
+      test.handshake( isn, { .window_size = 20000, .mss = 1460 } );
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1461 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 80 ).with_seqno( isn + 2921 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.mtu_probing = true;
+
+      TCPSenderTestHarness test { "A smaller peer MSS is respected", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000, .mss = 536 } );
+      test.execute( ExpectMSS { 536 } );
+      test.execute( Push { string( 1000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 536 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 464 ).with_seqno( isn + 537 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.mtu_probing = true;
+
+      TCPSenderTestHarness test { "MTU probes raise the MSS", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000, .mss = 1460 } );
+      test.execute( ExpectMSS { 1000 } );
+
+      // The first full segment probes halfway between 1000 and 1460
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1230 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1231 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 770 ).with_seqno( isn + 2231 ) );
+      test.execute( Receive { { .ackno = isn + 1231, .window_size = 20000 } } );
+      test.execute( ExpectMSS { 1230 } );
+
+      // ... and the next one halfway between 1230 and 1460
+      test.execute( Push { string( 2000, 'y' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1345 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 655 ).with_seqno( isn + 4346 ) );
+      test.execute( Receive { { .ackno = isn + 5001, .window_size = 20000 } } );
+      test.execute( ExpectMSS { 1345 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.mtu_probing = true;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "A lost probe is not congestion", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000, .mss = 1460 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1230 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1231 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 770 ).with_seqno( isn + 2231 ) );
+
+      // The probe is repaired in segments of the old MSS, without a window reduction
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( Receive { { .ackno = isn + 1, .window_size = 20000 } } );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 230 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 10001 } );
+      test.execute( ExpectMSS { 1000 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.mtu_probing = true;
+
+      TCPSenderTestHarness test { "Repeated timeouts fall back to a smaller MSS",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000, .mss = 1460 } );
+      test.execute( Push { string( 1230, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1230 ).with_seqno( isn + 1 ) );
+
+      // The failed probe is resent in pieces of the current MSS
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 230 ).with_seqno( isn + 1001 ) );
+      test.execute( Tick { uint64_t { 2 } * cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 230 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMSS { 1000 } );
+
+      // Still nothing: perhaps a black hole that drops 1000-byte segments too
+      test.execute( Tick { uint64_t { 4 } * cfg.rt_timeout } );
+      test.execute( ExpectMSS { 500 } );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 500 ).with_seqno( isn + 501 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 230 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
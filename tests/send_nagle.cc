@@ -0,0 +1,81 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "No delay sends small writes at once", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "cd" } );
+      test.execute( ExpectMessage {}.with_data( "cd" ).with_seqno( isn + 3 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.no_delay = false;
+
+      TCPSenderTestHarness test { "Nagle holds small writes while data is in flight",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "cd" } );
+      test.execute( Push { "ef" } );
+      test.execute( ExpectNoSegment {} );
+
+      // The ACK empties the pipe, and the held bytes go out as one segment
+      test.execute( Receive { { .ackno = isn + 3, .window_size = 20000 } } );
+      test.execute( ExpectMessage {}.with_data( "cdef" ).with_seqno( isn + 3 ) );
+
+      // A full segment is never held
+      test.execute( Push { string( 1500, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 7 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // Nor is the last segment of the stream
+      test.execute( Push { "gh" }.with_close() );
+      test.execute( ExpectMessage {}.with_payload_size( 502 ).with_fin( true ).with_seqno( isn + 1007 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "Cork holds partial segments until uncorked",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000 } );
+      test.execute( SetCork { true } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Push { string( 1200, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( SetCork { false } );
+      test.execute( ExpectMessage {}.with_payload_size( 202 ).with_seqno( isn + 1001 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "Without pacing a window goes out at once",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000 } );
+      test.execute( ExpectPacingRate { 0 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTimeUntilDeparture { nullopt } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.pacing = true;
+      cfg.max_pacing_rate = 2'000'000;
+
+      TCPSenderTestHarness test { "Pacing at a fixed rate", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000 } );
+      test.execute( ExpectPacingRate { 2'000'000 } );
+
+      // 2,000,000 bytes per second: one 1000-byte segment every 500 us
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTimeUntilDeparture { 500 } );
+
+      // A millisecond tick releases the two segments that fell due
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTimeUntilDeparture { 500 } );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 4001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectTimeUntilDeparture { nullopt } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.pacing = true;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "Pacing follows cwnd / SRTT", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 20000, .rtt = 100 } );
+
+      // Slow start doubles the rate: 2 * 10001 bytes per 100 ms
+      test.execute( ExpectPacingRate { 200'020 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 4 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 5 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // Retransmissions are not paced
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
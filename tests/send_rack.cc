@@ -0,0 +1,133 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true;
+      cfg.rack = true;
+      cfg.rto_min = 1000;
+
+      TCPSenderTestHarness test { "RACK declares a loss once later data is SACKed",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      // A measured RTT of 40 ms, so SRTT = min-RTT = 40 ms
+      test.handshake( isn, { .window_size = 1000, .rtt = 40 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      for ( const auto* data : { "ab", "cd", "ef", "gh" } ) {
+        test.execute( Push { data } );
+        test.execute( ExpectMessage {}.with_data( data ) );
+      }
+      test.execute( Tick { 40 } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } }.with_sack( isn + 3, isn + 9 ) );
+      // Segments sent together may still be reordered: wait a quarter of the min-RTT before declaring loss
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 9 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { .ackno = isn + 9, .window_size = 1000 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true;
+      cfg.rack = true;
+      cfg.rto_min = 1000;
+
+      TCPSenderTestHarness test { "RACK declares a loss at once when a later-sent segment arrives",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .rtt = 40 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ) );
+      test.execute( Tick { 20 } );
+      test.execute( Push { "cd" } );
+      test.execute( ExpectMessage {}.with_data( "cd" ) );
+      test.execute( Tick { 40 } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } }.with_sack( isn + 3, isn + 5 ) );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true;
+      cfg.rack = true;
+      cfg.rto_min = 1000;
+
+      TCPSenderTestHarness test { "Tail loss probe retransmits the last segment",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .rtt = 40 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      // PTO = 2 * SRTT
+      test.execute( Tick { 79 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      // Only one probe until something new is acknowledged
+      test.execute( Tick { 200 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { .ackno = isn + 7, .window_size = 1000 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+
+      // With one segment in flight, the probe also allows for a delayed ACK
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ) );
+      test.execute( Tick { 279 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_seqno( isn + 7 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true;
+      cfg.rto_min = 1000;
+
+      TCPSenderTestHarness test { "Without RACK-TLP, tail losses wait for the RTO",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .rtt = 40 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ) );
+      test.execute( Push { "cd" } );
+      test.execute( ExpectMessage {}.with_data( "cd" ) );
+      test.execute( Tick { 40 } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } }.with_sack( isn + 3, isn + 5 ) );
+      test.execute( Tick { 959 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
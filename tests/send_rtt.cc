@@ -0,0 +1,102 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.rto_min = 10;
+      cfg.rto_max = 500;
+      cfg.rack = false; // Tail loss probes would preempt the timeouts under test
+
+      TCPSenderTestHarness test { "RTO follows the measured RTT", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( ExpectRetransmissionTimeout { cfg.rt_timeout } );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      // SRTT = 50, RTTVAR = 25: RTO = 50 + 4 * 25
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( ExpectRetransmissionTimeout { 150 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 30 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } } );
+      // RTTVAR = 3/4 * 25 + 1/4 * 20, SRTT = 7/8 * 50 + 1/8 * 30: RTO = ceil(47.5 + 95)
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( ExpectRetransmissionTimeout { 143 } );
+
+      // Karn's rule: the ACK of a retransmitted segment is not a sample
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      test.execute( Tick { 142 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      test.execute( ExpectRetransmissionTimeout { 286 } );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } } );
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( ExpectRetransmissionTimeout { 143 } );
+
+      // Backoff stops at the configured maximum
+      test.execute( Push { "ghi" } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_seqno( isn + 7 ) );
+      test.execute( Tick { 143 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_seqno( isn + 7 ) );
+      test.execute( Tick { 286 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_seqno( isn + 7 ) );
+      test.execute( ExpectRetransmissionTimeout { 500 } );
+      test.execute( Tick { 500 } );
+      test.execute( ExpectMessage {}.with_data( "ghi" ).with_seqno( isn + 7 ) );
+      test.execute( ExpectRetransmissionTimeout { 500 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "RTO never falls below the minimum", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 2 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectRetransmissionTimeout { cfg.rto_min } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.adaptive_rto = false;
+
+      TCPSenderTestHarness test { "Fixed RTO when estimation is off", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 2 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( ExpectRetransmissionTimeout { cfg.rt_timeout } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "An RTO resends the first segment and forgets the SACKs", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "cd" } );
+      test.execute( ExpectMessage {}.with_data( "cd" ).with_seqno( isn + 3 ) );
+      test.execute( Push { "ef" } );
+      test.execute( ExpectMessage {}.with_data( "ef" ).with_seqno( isn + 5 ) );
+      test.execute( Push { "gh" } );
+      test.execute( ExpectMessage {}.with_data( "gh" ).with_seqno( isn + 7 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } }
+                      .with_sack( isn + 3, isn + 5 )
+                      .with_sack( isn + 7, isn + 9 ) );
+      test.execute( ExpectSeqnosInFlight { 8 } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 9 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "A SACKed segment dropped by the receiver is resent after an RTO", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+      test.execute( Push { "cd" } );
+      test.execute( ExpectMessage {}.with_data( "cd" ).with_seqno( isn + 3 ) );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } }.with_sack( isn + 3, isn + 5 ) );
+      test.execute( Receive { { .ackno = isn + 3, .window_size = 1000 } }.with_sack( isn + 3, isn + 5 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // The receiver then discards "cd" (RFC 2018 reneging): every RTO must still resend it
+      test.execute( Receive { { .ackno = isn + 3, .window_size = 1000 } } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "cd" ).with_seqno( isn + 3 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 2U * cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "cd" ).with_seqno( isn + 3 ) );
+      test.execute( AckReceived { Wrap32 { isn + 5 } } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "SACK blocks outside the outstanding data are ignored", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( Push { "abcd" } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_seqno( isn + 1 ) );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } }
+                      .with_sack( isn + 3, isn + 20 )
+                      .with_sack( isn + 4, isn + 2 ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "abcd" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
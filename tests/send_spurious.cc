@@ -0,0 +1,99 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+// Send "ab" and "cd", then let the retransmission timer resend "ab"
+void time_out( TCPSenderTestHarness& test, Wrap32 isn, const TCPConfig& cfg )
+{
+  test.handshake( isn, { .window_size = 1000 } );
+  test.execute( ExpectCongestionWindow { 10001 } );
+  test.execute( Push { "ab" } );
+  test.execute( ExpectMessage {}.with_data( "ab" ) );
+  test.execute( Push { "cd" } );
+  test.execute( ExpectMessage {}.with_data( "cd" ) );
+  test.execute( Tick { cfg.rt_timeout } );
+  test.execute( ExpectMessage {}.with_data( "ab" ).with_seqno( isn + 1 ) );
+  test.execute( ExpectCongestionWindow { 1000 } );
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true; // D-SACKs report the spurious retransmissions
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "D-SACK undoes a spurious timeout", cfg, TCPSenderTestHarness::FullConfig {} };
+      time_out( test, isn, cfg );
+      // The receiver already had "ab": the retransmission comes back as a D-SACK below the ackno
+      test.execute( Receive { { .ackno = isn + 5, .window_size = 1000 } }.with_sack( isn + 1, isn + 3 ) );
+      test.execute( ExpectCongestionWindow { 10001 } );
+      test.execute( ExpectSpuriousRetransmissions { 1 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+
+      // The same report repeated on a later ACK is not counted again
+      test.execute( Receive { { .ackno = isn + 5, .window_size = 1000 } }.with_sack( isn + 1, isn + 3 ) );
+      test.execute( ExpectSpuriousRetransmissions { 1 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "A genuine loss is not undone", cfg, TCPSenderTestHarness::FullConfig {} };
+      time_out( test, isn, cfg );
+      test.execute( Receive { { .ackno = isn + 5, .window_size = 1000 } } );
+      test.execute( ExpectCongestionWindow { 1004 } );
+      test.execute( ExpectSpuriousRetransmissions { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sack = true;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "D-SACK undoes a spurious fast retransmit",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 60000 } );
+      test.execute( Push { string( 5000, 'x' ) } );
+      for ( uint32_t i = 0; i < 5; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+
+      // Reordering, not loss: the first segment arrives after three later ones
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( Receive { { .ackno = isn + 1, .window_size = 60000 } } );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectFastRecovery { true } );
+      test.execute( ExpectCongestionWindow { 2500 } );
+
+      test.execute( Receive { { .ackno = isn + 5001, .window_size = 60000 } }.with_sack( isn + 1, isn + 1001 ) );
+      test.execute( ExpectFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 10001 } );
+      test.execute( ExpectSpuriousRetransmissions { 1 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+// Open a 3000-byte window and fill it
+void fill_window( TCPSenderTestHarness& test, Wrap32 isn )
+{
+  test.handshake( isn, { .window_size = 3000 } );
+  test.execute( Push { string( 5000, 'x' ) } );
+  for ( uint32_t i = 0; i < 3; ++i ) {
+    test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sws_avoidance = true;
+
+      TCPSenderTestHarness test { "Small windows wait while data is in flight",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      fill_window( test, isn );
+
+      // 300 bytes of room: neither a full segment nor half the largest window
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 2300 } } );
+      test.execute( ExpectNoSegment {} );
+
+      // Room for a full segment: send it, and hold the rest again
+      test.execute( Receive { { .ackno = isn + 2001, .window_size = 2500 } } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.sws_avoidance = true;
+
+      TCPSenderTestHarness test { "An idle sender uses a small window", cfg, TCPSenderTestHarness::FullConfig {} };
+      fill_window( test, isn );
+      test.execute( Receive { { .ackno = isn + 3001, .window_size = 300 } } );
+      test.execute( ExpectMessage {}.with_payload_size( 300 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "Without SWS avoidance small windows are filled",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      fill_window( test, isn );
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 2300 } } );
+      test.execute( ExpectMessage {}.with_payload_size( 300 ).with_seqno( isn + 3001 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
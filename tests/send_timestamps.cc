@@ -0,0 +1,135 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Timestamps on every segment once echoed",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .rtt = 10, .timestamp_echo = 0 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( 10 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "No timestamps unless the peer echoes them",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( 0 ) );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( nullopt ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Passive open answers a SYN with timestamps",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.execute( Receive { { .window_size = 1000 } }.without_push() );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ).with_timestamp( 0 ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Passive open without timestamps from the peer",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.execute( Receive { { .window_size = 1000 } }.on_syn_without_timestamp().without_push() );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ).with_timestamp( nullopt ) );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 1000 } } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( nullopt ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "Timestamps can be turned off", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_timestamp( nullopt ) );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.timestamps = true;
+
+      TCPSenderTestHarness test { "Retransmitted segments are sampled through the echo",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .rtt = 10, .timestamp_echo = 0 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( 10 ) );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( 210 ) );
+      test.execute( Tick { 10 } );
+      // Karn's rule would skip this ACK; the echo says which transmission it answers
+      test.execute( Receive { { .ackno = isn + 3, .window_size = 1000 } }.with_timestamp_echo( 210 ) );
+      test.execute( ExpectRTTSamples { 2 } );
+      test.execute( ExpectSpuriousRetransmissions { 0 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.timestamps = true;
+      cfg.congestion_control = CongestionControlAlgorithm::NewReno;
+
+      TCPSenderTestHarness test { "Echo of the original transmission undoes a timeout",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .rtt = 10, .timestamp_echo = 0 } );
+      test.execute( ExpectRTTSamples { 1 } );
+      test.execute( ExpectCongestionWindow { 10001 } );
+      test.execute( Push { "ab" } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( 10 ) );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_data( "ab" ).with_timestamp( 210 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( Tick { 10 } );
+      test.execute( Receive { { .ackno = isn + 3, .window_size = 1000 } }.with_timestamp_echo( 10 ) );
+      test.execute( ExpectSpuriousRetransmissions { 1 } );
+      test.execute( ExpectCongestionWindow { 10001 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+namespace {
+void expect_segments( TCPSenderTestHarness& test, Wrap32 first, uint32_t count )
+{
+  for ( uint32_t i = 0; i < count; ++i ) {
+    test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( first + 1000 * i ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+} // namespace
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "Window scale multiplies the peer's windows",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      // The window on the SYN-ACK that offers the shift is not scaled
+      test.handshake( isn, { .window_size = 1000, .window_scale = 2 } );
+      test.execute( Push { string( 5000, 'x' ) } );
+      expect_segments( test, isn + 1, 1 );
+
+      // Later segments carry no option: the shift from the SYN applies to them
+      test.execute( Receive { { .ackno = isn + 1001, .window_size = 1000 } } );
+      expect_segments( test, isn + 1001, 4 );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.window_scaling = true;
+      cfg.send_capacity = 200000;
+
+      TCPSenderTestHarness test { "Windows beyond 64 KiB", cfg, TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 10000, .window_scale = 4 } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 10000 } } );
+      test.execute( Push { string( 150000, 'x' ) } );
+      expect_segments( test, isn + 1, 150 );
+      test.execute( ExpectSeqnosInFlight { 150000 } );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      const TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+
+      TCPSenderTestHarness test { "No scaling unless both endpoints offer it",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 1000, .window_scale = 2 } );
+      test.execute( Push { string( 5000, 'x' ) } );
+      expect_segments( test, isn + 1, 1 );
+    }
+
+    {
+      const Wrap32 isn( rd() );
+      TCPConfig cfg = TCPSenderTestHarness::minimal_config( isn );
+      cfg.window_scaling = true;
+
+      TCPSenderTestHarness test { "Shift counts above 14 are treated as 14",
+                                  cfg,
+                                  TCPSenderTestHarness::FullConfig {} };
+      test.handshake( isn, { .window_size = 0, .window_scale = 20 } );
+      test.execute( Receive { { .ackno = isn + 1, .window_size = 2 } } );
+      test.execute( Push { string( 40000, 'x' ) } );
+      for ( uint32_t i = 0; i < 32; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 768 ).with_seqno( isn + 32001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << "\n";
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -58,6 +58,44 @@ public:
                    { .sender = TCPSender { ByteStream { config.send_capacity }, config.isn, config.rt_timeout } } )
   {}
 
+  // Construct the sender from the whole TCPConfig, including the TCP extensions it selects
+  struct FullConfig
+  {};
+  TCPSenderTestHarness( std::string name, const TCPConfig& config, FullConfig /* unused */ )
+    : TestHarness( move( name ),
+                   "initial_RTO_ms=" + to_string( config.rt_timeout ) + " and ISN=" + to_string( config.isn )
+                     + " with full config",
+                   { .sender = TCPSender { ByteStream { config.send_capacity }, config } } )
+  {}
+
+  // A config with every optional TCP extension turned off, for tests that turn on the one they exercise
+  static TCPConfig minimal_config( Wrap32 isn )
+  {
+    TCPConfig cfg;
+    cfg.isn = isn;
+    cfg.sack = false;
+    cfg.window_scaling = false;
+    cfg.timestamps = false;
+    cfg.mtu_probing = false;
+    cfg.sws_avoidance = false;
+    cfg.rack = false;
+    cfg.congestion_control = CongestionControlAlgorithm::None;
+    return cfg;
+  }
+
+  // The peer's SYN-ACK: its window and SYN options, and how long after our SYN it arrives
+  struct SynAck
+  {
+    uint16_t window_size = DEFAULT_TEST_WINDOW;
+    uint64_t rtt = 0;
+    std::optional<uint8_t> window_scale {};
+    std::optional<uint16_t> mss {};
+    std::optional<uint32_t> timestamp_echo {};
+  };
+
+  // Send the SYN and have it acknowledged by `syn_ack`
+  void handshake( Wrap32 isn, const SynAck& syn_ack );
+
   template<std::derived_from<TestStep<TCPSender>> T>
   void execute( const T& test )
   {
@@ -67,6 +105,65 @@ public:
   using TestHarness<SenderAndOutput>::execute;
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.congestion_window(); }
+};
+
+struct ExpectRetransmissionTimeout : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "retransmission_timeout"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.retransmission_timeout(); }
+};
+
+struct ExpectRTTSamples : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "rtt().samples"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.rtt().samples(); }
+};
+
+struct ExpectFastRecovery : public ExpectBool<TCPSender>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_fast_recovery"; }
+  bool value( const TCPSender& sender ) const override { return sender.in_fast_recovery(); }
+};
+
+struct ExpectSpuriousRetransmissions : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "spurious_retransmissions"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.spurious_retransmissions(); }
+};
+
+struct ExpectMSS : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "mss"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.mss(); }
+};
+
+struct ExpectPacingRate : public ExpectNumber<TCPSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pacing_rate"; }
+  uint64_t value( const TCPSender& sender ) const override { return sender.pacing_rate(); }
+};
+
+struct ExpectTimeUntilDeparture : public ExpectNumber<TCPSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "time_until_departure_us"; }
+  std::optional<uint64_t> value( const TCPSender& sender ) const override
+  {
+    return sender.time_until_departure_us();
+  }
+};
+
 struct ExpectSeqno : public ExpectNumber<TCPSender, Wrap32>
 {
   using ExpectNumber::ExpectNumber;
@@ -217,12 +314,26 @@ struct Receive : public Action<SenderAndOutput>
 {
   TCPReceiverMessage msg_;
   bool push_ = true;
+  bool syn_without_timestamp_ = false;
 
   explicit Receive( TCPReceiverMessage msg ) : msg_( msg ) {}
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    if ( msg_.window_scale.has_value() ) {
+      desc << ", wscale=" << static_cast<int>( *msg_.window_scale );
+    }
+    if ( msg_.timestamp_echo.has_value() ) {
+      desc << ", tsecr=" << *msg_.timestamp_echo;
+    }
+    for ( const auto& [left, right] : msg_.sack_blocks ) {
+      desc << ", sack=" << to_string( left ) << "-" << to_string( right );
+    }
+    desc << ")";
+    if ( syn_without_timestamp_ ) {
+      desc << " on a SYN without timestamp";
+    }
     if ( push_ ) {
       desc << ", then push";
     }
@@ -235,9 +346,33 @@ struct Receive : public Action<SenderAndOutput>
     return *this;
   }
 
+  Receive& with_window_scale( uint8_t shift )
+  {
+    msg_.window_scale = shift;
+    return *this;
+  }
+
+  Receive& with_mss( uint16_t mss )
+  {
+    msg_.mss = mss;
+    return *this;
+  }
+
+  Receive& with_timestamp_echo( uint32_t tsecr )
+  {
+    msg_.timestamp_echo = tsecr;
+    return *this;
+  }
+
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack_blocks.emplace_back( left, right );
+    return *this;
+  }
+
   void execute( SenderAndOutput& ss ) const override
   {
-    ss.sender.receive( msg_ );
+    ss.sender.receive( msg_, false, syn_without_timestamp_ );
     if ( push_ ) {
       ss.sender.push( ss.make_transmit() );
     }
@@ -249,6 +384,13 @@ struct Receive : public Action<SenderAndOutput>
     return *this;
   }
 
+  // The message arrives on the peer's SYN, which offers no timestamps
+  Receive& on_syn_without_timestamp()
+  {
+    syn_without_timestamp_ = true;
+    return *this;
+  }
+
   constexpr std::string obj() const override { return "TCPSender"; }
 };
 
@@ -262,6 +404,21 @@ struct Close : public Push
   Close() : Push( "" ) { with_close(); }
 };
 
+struct SetCork : public Action<SenderAndOutput>
+{
+  bool corked_;
+
+  explicit SetCork( bool corked ) : corked_( corked ) {}
+  std::string description() const override { return corked_ ? "cork, then push" : "uncork, then push"; }
+  void execute( SenderAndOutput& ss ) const override
+  {
+    ss.sender.set_corked( corked_ );
+    ss.sender.push( ss.make_transmit() );
+  }
+
+  constexpr std::string obj() const override { return "TCPSender"; }
+};
+
 class MessageExpectationViolation : public ExpectationViolation
 {
 public:
@@ -283,8 +440,9 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
   std::optional<Wrap32> seqno {};
   std::optional<std::string> data {};
   std::optional<size_t> payload_size {};
+  std::optional<std::optional<uint32_t>> timestamp {};
 
-  bool empty() const { return not( syn or fin or rst or seqno or data or payload_size ); }
+  bool empty() const { return not( syn or fin or rst or seqno or data or payload_size or timestamp ); }
 
   ExpectMessage& with_syn( bool syn_ )
   {
@@ -330,6 +488,12 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     return *this;
   }
 
+  ExpectMessage& with_timestamp( std::optional<uint32_t> timestamp_ )
+  {
+    timestamp = timestamp_;
+    return *this;
+  }
+
   std::string message_description() const
   {
     std::ostringstream o;
@@ -361,6 +525,9 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( rst.has_value() ) {
       o << ( rst.value() ? " +RST" : " -RST" );
     }
+    if ( timestamp.has_value() ) {
+      o << " timestamp=" << to_string( timestamp.value() );
+    }
     return o.str();
   }
 
@@ -377,10 +544,10 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
 
     const TCPSenderMessage seg = ss.expect_message();
 
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.sender.max_mss() ) {
       throw ExpectationViolation( "sent a message with a " + std::to_string( seg.payload.size() )
                                   + "-byte payload, which is longer than the maximum ("
-                                  + std::to_string( TCPConfig::MAX_PAYLOAD_SIZE ) + ")" );
+                                  + std::to_string( ss.sender.max_mss() ) + ")" );
     }
     if ( syn.has_value() and seg.SYN != syn.value() ) {
       throw MessageExpectationViolation( seg, "SYN flag", syn.value(), seg.SYN );
@@ -400,7 +567,24 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( data.has_value() and data.value() != static_cast<std::string>( seg.payload ) ) {
       throw MessageExpectationViolation( seg, "payload", data.value(), static_cast<std::string>( seg.payload ) );
     }
+    if ( timestamp.has_value() and seg.timestamp != timestamp.value() ) {
+      throw MessageExpectationViolation( seg, "timestamp", timestamp.value(), seg.timestamp );
+    }
   }
 
   constexpr std::string obj() const override { return "TCPSender"; }
 };
+
+inline void TCPSenderTestHarness::handshake( Wrap32 isn, const SynAck& syn_ack )
+{
+  execute( Push {} );
+  execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+  if ( syn_ack.rtt > 0 ) {
+    execute( Tick { syn_ack.rtt } );
+  }
+  execute( Receive { { .ackno = isn + 1,
+                       .window_size = syn_ack.window_size,
+                       .window_scale = syn_ack.window_scale,
+                       .timestamp_echo = syn_ack.timestamp_echo,
+                       .mss = syn_ack.mss } } );
+}
@@ -0,0 +1,24 @@
+#include "eventfd.hh"
+#include "exception.hh"
+
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+EventFD::EventFD() : FileDescriptor( ::CheckSystemCall( "eventfd", eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) ) {}
+
+void EventFD::notify()
+{
+  const uint64_t increment = 1;
+  CheckFDSystemCall( "write", ::write( fd_num(), &increment, sizeof( increment ) ) );
+  register_write();
+}
+
+void EventFD::clear()
+{
+  uint64_t counter {};
+  CheckFDSystemCall( "read", ::read( fd_num(), &counter, sizeof( counter ) ) );
+  register_read();
+}
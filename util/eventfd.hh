@@ -0,0 +1,18 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+//! A non-blocking FileDescriptor to a Linux [eventfd](\ref man2::eventfd) counter,
+//! used by one thread to wake another thread's EventLoop
+class EventFD : public FileDescriptor
+{
+public:
+  //! Create an eventfd whose counter starts at zero
+  EventFD();
+
+  //! Add one to the counter, making the descriptor readable
+  void notify();
+
+  //! Reset the counter to zero (does nothing if it is already zero)
+  void clear();
+};
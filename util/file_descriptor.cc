@@ -144,6 +144,38 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 }
 
+// Read directly into a list of writable spans (none of which may be empty).
+size_t FileDescriptor::read( const vector<span<char>>& buffers )
+{
+  if ( buffers.empty() ) {
+    throw runtime_error( "FileDescriptor::read called with no buffers" );
+  }
+
+  static thread_local vector<iovec> iovecs;
+  iovecs.clear();
+  size_t total_size = 0;
+  for ( const auto& buf : buffers ) {
+    if ( buf.empty() ) {
+      throw runtime_error( "FileDescriptor::read called with empty buffer in buffer list" );
+    }
+    if ( iovecs.size() == IOV_MAX ) {
+      break;
+    }
+    iovecs.push_back( { buf.data(), buf.size() } );
+    total_size += buf.size();
+  }
+
+  const size_t bytes_read
+    = CheckRead( "readv", readv( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) ) );
+  register_read();
+
+  if ( bytes_read > total_size ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
 void FileDescriptor::write_all( string_view buffer )
 {
   if ( not blocking() ) {
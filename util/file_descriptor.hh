@@ -2,9 +2,12 @@
 
 #include "string_view_range.hh"
 
+#include <algorithm>
 #include <bits/types/struct_iovec.h>
+#include <climits>
 #include <cstddef>
 #include <memory>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -20,12 +23,19 @@ public:
   // 参数为vector的重载，用于一组缓冲区，在buffers中给定resize后的string对象可切分传入数据（获取header等)
   void read( std::vector<std::string>& buffers );
 
+  // Read (with a single readv) into caller-owned memory, e.g. spans from Writer::reserve().
+  // Returns the number of bytes read, filling the spans in order.
+  size_t read( const std::vector<std::span<char>>& buffers );
+
   // `write_all` writes a buffer completely.
   void write_all( std::string_view buffer );
 
   // `write` writes *from* a buffer or range of buffers and returns the number of bytes it actually wrote.
+  // A range of buffers is written with a single writev (at most IOV_MAX buffers per call).
   size_t write( std::string_view buffer );
-  size_t write( const StringViewRange auto&& buffers )
+  size_t write( const StringViewRange auto&& buffers ) { return write( buffers ); }
+  // The same for a range the caller keeps (e.g. a list of views filled by Reader::peek)
+  size_t write( const StringViewRange auto& buffers )
   {
     static thread_local std::vector<iovec> iovecs;
     const size_t total_size = to_iovecs( buffers, iovecs );
@@ -109,16 +119,19 @@ protected:
   size_t CheckFDSystemCall( std::string_view what, ssize_t return_value ) const;
   size_t CheckRead( std::string_view what, ssize_t return_value );
 
-  // Convert a range of string_view-convertible objects to a vector of iovecs
+  // Convert a range of string_view-convertible objects to a vector of (at most IOV_MAX) iovecs
   static size_t to_iovecs( const StringViewRange auto& buffers, std::vector<iovec>& iovecs )
   {
     if ( buffers.empty() ) {
       throw std::runtime_error( "to_iovecs called with empty buffer list" );
     }
     iovecs.clear();
-    iovecs.reserve( buffers.size() );
+    iovecs.reserve( std::min<size_t>( buffers.size(), IOV_MAX ) );
     size_t total_size = 0;
     for ( const auto& buf : buffers ) {
+      if ( iovecs.size() == IOV_MAX ) {
+        break; // the syscall can't take any more; the caller sees a short read or write
+      }
       const std::string_view x { buf };
       if ( x.empty() ) {
         throw std::runtime_error( "to_iovecs called with empty buffer in buffer list" );
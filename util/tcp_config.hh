@@ -6,6 +6,14 @@
 #include <cstddef>
 #include <cstdint>
 
+//! Congestion control algorithm used by a TCP sender
+enum class CongestionControlAlgorithm : uint8_t
+{
+  None,    //!< No congestion window; limited only by the peer's window
+  NewReno, //!< RFC 5681/6582
+  Cubic,   //!< RFC 9438
+};
+
 //! Config for TCP sender and receiver
 class TCPConfig
 {
@@ -16,9 +24,28 @@ public:
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
+  bool adaptive_rto = true;                //!< Derive the RTO from measured round-trip times (RFC 6298)
+  uint16_t rto_min = 200;                  //!< Lower bound of the adaptive RTO, in milliseconds
+  uint16_t rto_max = 60000;                //!< Upper bound of the RTO, including backoff, in milliseconds
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
+  //! The spill file lives in $TMPDIR (default /tmp). If that is a tmpfs, evicted pages stay in shared memory
+  //! (RAM or swap), so the limit saves no memory; point TMPDIR at a disk-backed directory instead.
+  size_t recv_memory_limit = 0;            //!< Receive bytes kept in memory before spilling to disk (0 = never)
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+  bool sack = true;                        //!< Offer and use selective acknowledgments (RFC 2018)
+  bool window_scaling = true;              //!< Offer window scaling (RFC 7323) so windows can exceed 64 KiB
+  bool timestamps = true;                  //!< Offer timestamps (RFC 7323): an RTT sample per ACK, and PAWS
+  uint16_t mss = 1460;                     //!< Largest payload this host sends or accepts (0 = don't negotiate)
+  bool mtu_probing = true;                 //!< Path MTU discovery (RFC 4821) from MAX_PAYLOAD_SIZE up to the MSS
+  bool no_delay = true;                    //!< Send partial segments at once; false enables Nagle's algorithm
+  uint16_t delayed_ack_ms = 40;            //!< Longest wait to acknowledge in-order data (0 = ACK every segment)
+  bool sws_avoidance = true;               //!< Avoid the silly window syndrome (RFC 1122) on both sides
+  bool pacing = false;                     //!< Spread each window of new data over the RTT instead of one burst
+  uint64_t max_pacing_rate = 0;            //!< Cap on the pacing rate, in bytes per second (0 = none)
+  unsigned dup_ack_threshold = 3;          //!< Duplicate ACKs that trigger fast retransmit (0 = never)
+  bool rack = true;                        //!< RACK-TLP time-based loss detection (RFC 8985)
+  CongestionControlAlgorithm congestion_control = CongestionControlAlgorithm::Cubic; //!< Sender's window policy
 };
 
 //! Config for classes derived from FdAdapter
@@ -10,7 +10,10 @@
 #include <atomic>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 //! Multithreaded wrapper around TCPPeer that approximates the Unix sockets API
 template<TCPDatagramAdapter AdaptT>
@@ -53,6 +56,12 @@ public:
   void set_reuseaddr() = delete;
   //!@}
 
+  //! Hold back partial segments until uncork() (like TCP_CORK, or MSG_MORE on each write)
+  void cork() { _corked.store( true ); }
+
+  //! Send any partial segment held back by cork()
+  void uncork() { _corked.store( false ); }
+
   // Return peer address from underlying datagram adapter
   const Address& peer_address() const { return _datagram_adapter.config().destination; }
 
@@ -62,6 +71,7 @@ protected:
 
 private:
   //! Stream socket for reads and writes between owner and TCP thread
+  //! \note Owners read and write this socket's fd directly, so it is not replaced by a ConcurrentByteStream pair
   LocalStreamSocket _thread_data;
 
   //! Set up the TCPPeer and the event loop
@@ -87,11 +97,17 @@ private:
 
   std::atomic_bool _abort { false }; //!< Flag used by the owner to force the TCPPeer thread to shut down
 
+  std::atomic_bool _corked { false }; //!< Set by the owner's cork()/uncork(), applied by the TCPPeer thread
+
   bool _inbound_shutdown { false }; //!< Has TCPMinnowSocket shut down the incoming data to the owner?
 
   bool _outbound_shutdown { false }; //!< Has the owner shut down the outbound data to the TCP connection?
 
   bool _fully_acked { false }; //!< Has the outbound data been fully acknowledged by the peer?
+
+  std::vector<std::span<char>> _outbound_buffers {}; //!< Outbound stream space the owner's bytes are read into
+
+  std::vector<std::string_view> _inbound_buffers {}; //!< Inbound stream bytes written to the owner
 };
 
 using TCPOverIPv4MinnowSocket = TCPMinnowSocket<TCPOverIPv4OverTunFdAdapter>;
@@ -2,30 +2,41 @@
 
 #include "exception.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <sys/socket.h>
 #include <utility>
+#include <vector>
 
-static constexpr size_t TCP_TICK_MS = 10;
+static constexpr int TCP_TICK_MS = 10;
 
-inline uint64_t timestamp_ms()
+inline uint64_t timestamp_us()
 {
   static_assert( std::is_same_v<std::chrono::steady_clock::duration, std::chrono::nanoseconds> );
 
-  return std::chrono::steady_clock::now().time_since_epoch().count() / 1000000;
+  return std::chrono::steady_clock::now().time_since_epoch().count() / 1000;
 }
 
 //! \param[in] condition is a function returning true if loop should continue
 template<TCPDatagramAdapter AdaptT>
 void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition )
 {
-  auto base_time = timestamp_ms();
+  auto base_time = timestamp_us();
   while ( condition() ) {
-    auto ret = _eventloop.wait_next_event( TCP_TICK_MS );
+    // Wake up in time for a segment held back by pacing
+    int timeout_ms = TCP_TICK_MS;
+    if ( _tcp.has_value() ) {
+      if ( const auto departure_us = _tcp->sender().time_until_departure_us() ) {
+        timeout_ms = std::min( timeout_ms, static_cast<int>( ( departure_us.value() + 999 ) / 1000 ) );
+      }
+    }
+
+    auto ret = _eventloop.wait_next_event( timeout_ms );
     if ( ret == EventLoop::Result::Exit or _abort ) {
       break;
     }
@@ -35,9 +46,14 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const std::function<bool()>& condition
     }
 
     if ( _tcp.value().active() ) {
-      const auto next_time = timestamp_ms();
-      _tcp.value().tick( next_time - base_time, [&]( const auto& x ) { _datagram_adapter.write( x ); } );
-      _datagram_adapter.tick( next_time - base_time );
+      // uncork() flushes whatever partial segment was held back
+      if ( _tcp->sender().corked() != _corked.load() ) {
+        _tcp->set_corked( _corked.load(), [&]( const auto& x ) { _datagram_adapter.write( x ); } );
+      }
+
+      const auto next_time = timestamp_us();
+      _tcp.value().tick_us( next_time - base_time, [&]( const auto& x ) { _datagram_adapter.write( x ); } );
+      _datagram_adapter.tick( next_time / 1000 - base_time / 1000 );
       base_time = next_time;
     }
   }
@@ -99,10 +115,10 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      // Read straight into the outbound stream's storage (no intermediate string).
+      Writer& outbound = _tcp->outbound_writer();
+      outbound.reserve( outbound.available_capacity(), _outbound_buffers );
+      outbound.commit( _thread_data.read( _outbound_buffers ) );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -115,7 +131,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
                   << " still in flight).\n";
       }
 
-      _tcp->push( [&]( const auto& x ) { _datagram_adapter.write( x ); } );
+      _tcp->set_corked( _corked.load(), [&]( const auto& x ) { _datagram_adapter.write( x ); } );
     },
     [&] {
       return ( _tcp->active() ) and ( not _outbound_shutdown )
@@ -138,11 +154,11 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     [&] {
       Reader& inbound = _tcp->inbound_reader();
       // Write from the inbound_stream into
-      // the pipe, handling the possibility of a partial
-      // write (i.e., only pop what was actually written).
+      // the pipe with a single writev of everything buffered, handling
+      // the possibility of a partial write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        inbound.peek( inbound.bytes_buffered(), _inbound_buffers );
+        const auto bytes_written = _thread_data.write( _inbound_buffers );
         inbound.pop( bytes_written );
       }
 
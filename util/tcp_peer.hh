@@ -7,6 +7,7 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
 #include <functional>
 #include <optional>
 
@@ -28,10 +29,23 @@ public:
 
   /* Passthrough methods */
   void push( const TransmitFunction& transmit ) { sender_.push( make_send( transmit ) ); }
-  void tick( uint64_t t, const TransmitFunction& transmit )
+  void set_corked( bool corked, const TransmitFunction& transmit )
   {
-    cumulative_time_ += t;
-    sender_.tick( t, make_send( transmit ) );
+    sender_.set_corked( corked );
+    push( transmit );
+  }
+  void tick( uint64_t t, const TransmitFunction& transmit ) { tick_us( t * 1000, transmit ); }
+  void tick_us( uint64_t us, const TransmitFunction& transmit )
+  {
+    cumulative_time_us_ += us;
+    cumulative_time_ = cumulative_time_us_ / 1000;
+    sender_.tick_us( us, make_send( transmit ) );
+
+    // Send a delayed ACK when its timer expires, or a window update once the application has read enough
+    const bool ack_due = ack_deadline_.has_value() and cumulative_time_ >= ack_deadline_.value();
+    if ( has_ackno() and active() and ( ack_due or window_opened() ) ) {
+      send( sender_.make_empty_message(), transmit );
+    }
   }
   bool has_ackno() const { return receiver_.send().ackno.has_value(); }
 
@@ -56,19 +70,43 @@ public:
     // Record time in case this peer has to linger after streams finish.
     time_of_last_receipt_ = cumulative_time_;
 
-    // If SenderMessage occupies a sequence number, make sure to reply.
-    need_send_ |= ( msg.sender->sequence_length() > 0 );
+    // If SenderMessage occupies a sequence number, it will need an acknowledgment (maybe a delayed one).
+    const bool carries_data = msg.sender->sequence_length() > 0;
+    const Wrap32 seqno = msg.sender->seqno;
+    const auto length = static_cast<uint32_t>( msg.sender->sequence_length() );
+    const size_t payload_size = msg.sender->payload.size();
+    const bool syn_or_fin = msg.sender->SYN or msg.sender->FIN;
+    const bool syn_without_timestamp = msg.sender->SYN and not msg.sender->timestamp.has_value();
 
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
     const auto our_ackno = receiver_.send().ackno;
     need_send_ |= ( our_ackno.has_value() and msg.sender->seqno + 1 == our_ackno.value() );
 
-    // Give incoming TCPSenderMessage to receiver.
-    receiver_.receive( std::move( msg.sender ) );
-
-    // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( msg.receiver );
+    // Give incoming TCPSenderMessage to receiver (with the window scale option from the same segment, and
+    // whether the segment carries an ackno, i.e. the peer has seen our SYN).
+    receiver_.receive(
+      std::move( msg.sender ), msg.receiver->window_scale.has_value(), msg.receiver->ackno.has_value() );
+
+    // Give incoming TCPReceiverMessage to sender (and whether the peer's SYN left out the timestamp option).
+    sender_.receive( msg.receiver, carries_data, syn_without_timestamp );
+
+    // Acknowledge the SYN, the FIN, and out-of-order, duplicate or gap-filling data at once. Otherwise
+    // (RFC 1122/5681) wait for a second full-sized segment or for the delayed-ACK timer.
+    if ( carries_data ) {
+      const bool in_order = our_ackno.has_value() and seqno == our_ackno.value()
+                            and receiver_.send().ackno == seqno + length;
+      if ( cfg_.delayed_ack_ms == 0 or syn_or_fin or not in_order ) {
+        need_send_ = true;
+      } else {
+        unacked_bytes_ += payload_size;
+        largest_segment_ = std::max( largest_segment_, payload_size );
+        need_send_ |= unacked_bytes_ >= 2 * largest_segment_;
+        if ( not ack_deadline_.has_value() ) {
+          ack_deadline_ = cumulative_time_ + cfg_.delayed_ack_ms;
+        }
+      }
+    }
 
     // Send reply if needed.
     push( transmit );
@@ -88,18 +126,47 @@ public:
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity, ByteStream::Storage::Ring }, cfg_ };
+  TCPReceiver receiver_ { Reassembler { ByteStream {
+    cfg_.recv_capacity,
+    cfg_.recv_memory_limit ? ByteStream::Storage::Spill : ByteStream::Storage::Ring,
+    cfg_.recv_memory_limit },
+    Reassembler::Engine::Ring },
+    cfg_.window_scaling,
+    cfg_.mss ? std::optional<uint16_t> { cfg_.mss } : std::nullopt,
+    cfg_.sws_avoidance };
 
   bool need_send_ {};
 
+  // Delayed ACKs: in-order bytes received since the last acknowledgment, the largest segment seen (an
+  // estimate of the peer's MSS), and when the pending acknowledgment must be sent at the latest
+  size_t unacked_bytes_ {};
+  size_t largest_segment_ {};
+  std::optional<uint64_t> ack_deadline_ {};
+  uint16_t advertised_window_ {}; // Window in the last message sent
+
   void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
   {
-    transmit( { .sender = borrow( sender_message ), .receiver = receiver_.send() } );
+    TCPReceiverMessage receiver_message = receiver_.send();
+    if ( not sender_message.SYN ) {
+      receiver_message.window_scale.reset(); // The option is only carried on SYNs
+    }
+    advertised_window_ = receiver_message.window_size;
+    transmit( { .sender = borrow( sender_message ), .receiver = std::move( receiver_message ) } );
     need_send_ = false;
+    unacked_bytes_ = 0;
+    ack_deadline_.reset();
+  }
+
+  // Has the window at least doubled since it was last advertised (e.g. a slow reader caught up)?
+  bool window_opened() const
+  {
+    const uint16_t window = receiver_.send().window_size;
+    return window > advertised_window_ and window >= 2 * advertised_window_;
   }
 
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
   uint64_t cumulative_time_ {};
+  uint64_t cumulative_time_us_ {};
   uint64_t time_of_last_receipt_ {};
 };
@@ -2,26 +2,54 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <utility>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains seven fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
- *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    to receive, starting from the ackno if present, in units of 2^(window scale) once both
+ *    endpoints have offered window scaling. The maximum value is 65,535 (UINT16_MAX from the
+ *    <cstdint> header).
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) The SACK blocks (RFC 2018): ranges [left, right) of sequence numbers beyond the ackno that the
+ *    receiver already holds. The first block contains the most recently received segment. Only sent
+ *    if the peer's SYN offered SACK; a segment has room for at most MAX_SACK_BLOCKS of them.
+ *    A first block that lies below the ackno, or inside the second block, is a D-SACK (RFC 2883):
+ *    it reports data that arrived more than once.
+ *
+ * 5) The window scale (RFC 7323): present if the receiver offers window scaling, with the shift
+ *    count it applies to the windows it advertises (at most MAX_WINDOW_SCALE). It is only sent in
+ *    a segment with SYN set; the peer remembers it for the rest of the connection.
+ *
+ * 6) The timestamp echo (TSecr, RFC 7323): the timestamp of the peer's segment that most recently
+ *    advanced the ackno. Present once the peer's SYN carried a timestamp.
+ *
+ * 7) The maximum segment size (RFC 9293): the largest payload the receiver accepts in one segment.
+ *    Like the window scale, it is only sent in a segment with SYN set.
  */
 
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4;
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  std::optional<uint8_t> window_scale {};
   bool RST {};
+  std::vector<std::pair<Wrap32, Wrap32>> sack_blocks {};
+  std::optional<uint32_t> timestamp_echo {};
+  std::optional<uint16_t> mss {};
 };
@@ -3,12 +3,96 @@
 #include "helpers.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
 static_assert( !( TCPSegment::HEADER_LENGTH & 0x03 ) ); // header length must be divisible by 4
 
+namespace {
+// TCP option kinds (RFC 9293, RFC 7323, RFC 2018)
+enum TCPOption : uint8_t
+{
+  END_OF_OPTIONS = 0,
+  NO_OPERATION = 1,
+  MAXIMUM_SEGMENT_SIZE = 2,
+  WINDOW_SCALE = 3,
+  SACK_PERMITTED = 4,
+  SACK = 5,
+  TIMESTAMPS = 8,
+};
+
+constexpr uint8_t SACK_BLOCK_LENGTH = 8;
+constexpr uint8_t TIMESTAMPS_LENGTH = 10;
+
+uint32_t read_u32( string_view bytes )
+{
+  uint32_t ret = 0;
+  for ( const char c : bytes.substr( 0, 4 ) ) {
+    ret = ( ret << 8 ) | static_cast<uint8_t>( c );
+  }
+  return ret;
+}
+
+void parse_options( string_view options, TCPSenderMessage& sender, TCPReceiverMessage& receiver, Parser& parser )
+{
+  while ( not options.empty() ) {
+    const uint8_t kind = options.front();
+    if ( kind == END_OF_OPTIONS ) {
+      break;
+    }
+    if ( kind == NO_OPERATION ) {
+      options.remove_prefix( 1 );
+      continue;
+    }
+
+    // every other option has a length byte that counts the kind and length bytes too
+    if ( options.size() < 2 or static_cast<uint8_t>( options[1] ) < 2
+         or static_cast<uint8_t>( options[1] ) > options.size() ) {
+      parser.set_error();
+      return;
+    }
+    const uint8_t length = options[1];
+    const string_view body = options.substr( 2, length - 2 );
+
+    switch ( kind ) {
+      case MAXIMUM_SEGMENT_SIZE: // only meaningful in a SYN
+        if ( sender.SYN and body.size() == 2 ) {
+          receiver.mss = static_cast<uint16_t>( read_u32( body ) );
+        }
+        break;
+      case WINDOW_SCALE: // only meaningful in a SYN
+        if ( sender.SYN and body.size() == 1 ) {
+          receiver.window_scale = static_cast<uint8_t>( body.front() );
+        }
+        break;
+      case SACK_PERMITTED:
+        sender.SACK_permitted = true;
+        break;
+      case SACK:
+        for ( size_t i = 0; i + SACK_BLOCK_LENGTH <= body.size(); i += SACK_BLOCK_LENGTH ) {
+          receiver.sack_blocks.emplace_back( Wrap32 { read_u32( body.substr( i ) ) },
+                                             Wrap32 { read_u32( body.substr( i + 4 ) ) } );
+        }
+        break;
+      case TIMESTAMPS: // the echo is only meaningful with ACK set
+        if ( body.size() == TIMESTAMPS_LENGTH - 2 ) {
+          sender.timestamp = read_u32( body );
+          if ( receiver.ackno.has_value() ) {
+            receiver.timestamp_echo = read_u32( body.substr( 4 ) );
+          }
+        }
+        break;
+      default: // unknown options are skipped
+        break;
+    }
+
+    options.remove_prefix( length );
+  }
+}
+} // namespace
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
@@ -48,12 +132,17 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
+  // parse the options (anything extra in the header)
   if ( data_offset < ( HEADER_LENGTH >> 2 ) ) {
     parser.set_error();
     return;
   }
-  parser.remove_prefix( ( data_offset * 4 ) - HEADER_LENGTH );
+  string options( ( data_offset * 4 ) - HEADER_LENGTH, 0 );
+  parser.string( options );
+  if ( parser.has_error() ) {
+    return;
+  }
+  parse_options( options, message.sender, message.receiver, parser );
 
   parser.concatenate_all_remaining( message.sender->payload );
 }
@@ -64,13 +153,76 @@ public:
   uint32_t raw_value() const { return raw_value_; }
 };
 
+namespace {
+// Options are padded with NOPs so that multi-byte fields start on a 4-byte boundary
+string serialize_options( const TCPSenderMessage& sender, const TCPReceiverMessage& receiver )
+{
+  Serializer options;
+  size_t length = 0;
+
+  if ( sender.SYN and receiver.mss.has_value() ) {
+    options.integer( uint8_t { MAXIMUM_SEGMENT_SIZE } );
+    options.integer( uint8_t { 4 } );
+    options.integer( *receiver.mss );
+    length += 4;
+  }
+
+  if ( sender.SYN and receiver.window_scale.has_value() ) {
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { WINDOW_SCALE } );
+    options.integer( uint8_t { 3 } );
+    options.integer( *receiver.window_scale );
+    length += 4;
+  }
+
+  if ( sender.SYN and sender.SACK_permitted ) {
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { SACK_PERMITTED } );
+    options.integer( uint8_t { 2 } );
+    length += 4;
+  }
+
+  if ( sender.timestamp.has_value() ) {
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { TIMESTAMPS } );
+    options.integer( uint8_t { TIMESTAMPS_LENGTH } );
+    options.integer( *sender.timestamp );
+    options.integer( receiver.timestamp_echo.value_or( 0 ) );
+    length += TCPSegment::TIMESTAMPS_SPACE;
+  }
+
+  const size_t room = ( TCPSegment::MAX_OPTIONS_LENGTH - length - 4 ) / SACK_BLOCK_LENGTH;
+  const size_t blocks = min( { receiver.sack_blocks.size(), TCPReceiverMessage::MAX_SACK_BLOCKS, room } );
+  if ( blocks > 0 and receiver.ackno.has_value() ) {
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { NO_OPERATION } );
+    options.integer( uint8_t { SACK } );
+    options.integer( static_cast<uint8_t>( 2 + blocks * SACK_BLOCK_LENGTH ) );
+    for ( size_t i = 0; i < blocks; ++i ) {
+      options.integer( Wrap32Serializable { receiver.sack_blocks[i].first }.raw_value() );
+      options.integer( Wrap32Serializable { receiver.sack_blocks[i].second }.raw_value() );
+    }
+  }
+
+  string ret;
+  for ( const auto& buf : options.finish() ) {
+    ret += buf.get();
+  }
+  return ret;
+}
+} // namespace
+
 void TCPSegment::serialize( Serializer& serializer ) const
 {
+  const string options = serialize_options( message.sender, message.receiver );
+
   serializer.integer( udinfo.src_port );
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender->seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver->ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { ( HEADER_LENGTH >> 2 ) << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( ( ( HEADER_LENGTH + options.size() ) >> 2 ) << 4 ) ); // data offset
   const bool reset = message.sender->RST or message.receiver->RST;
   const uint8_t flags = ( message.receiver->ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( message.sender->SYN ? 0b0000'0010U : 0 ) | ( message.sender->FIN ? 0b0000'0001U : 0 );
@@ -78,6 +230,7 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( message.receiver->window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+  serializer.buffer( options );
   serializer.buffer( message.sender->payload );
 }
 
@@ -99,6 +252,15 @@ string TCPSegment::to_string() const
   ss << " seqno=" << Wrap32Serializable { message.sender->seqno }.raw_value();
   if ( message.sender->SYN ) {
     ss << " +SYN";
+    if ( message.sender->SACK_permitted ) {
+      ss << " +SACKOK";
+    }
+    if ( message.receiver->mss.has_value() ) {
+      ss << " mss=" << *message.receiver->mss;
+    }
+    if ( message.receiver->window_scale.has_value() ) {
+      ss << " wscale=" << static_cast<int>( *message.receiver->window_scale );
+    }
   }
   if ( not message.sender->payload.empty() ) {
     ss << " payload=\"" << pretty_print( message.sender->payload ) << "\"";
@@ -113,6 +275,13 @@ string TCPSegment::to_string() const
   if ( ackno.has_value() ) {
     ss << " ACK<" << Wrap32Serializable { *ackno }.raw_value() << ">";
   }
+  for ( const auto& [left, right] : message.receiver->sack_blocks ) {
+    ss << " SACK<" << Wrap32Serializable { left }.raw_value() << "-" << Wrap32Serializable { right }.raw_value()
+       << ">";
+  }
+  if ( message.sender->timestamp.has_value() ) {
+    ss << " TS<" << *message.sender->timestamp << "," << message.receiver->timestamp_echo.value_or( 0 ) << ">";
+  }
   ss << " winsize=" << message.receiver->window_size;
   ss << " src=" << udinfo.src_port << " dst=" << udinfo.dst_port;
   return ss.str();
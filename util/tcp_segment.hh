@@ -27,7 +27,9 @@ struct TCPSegment
 
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
 
-  static constexpr uint8_t HEADER_LENGTH = 20; // TCP header length, not including options
+  static constexpr uint8_t HEADER_LENGTH = 20;      // TCP header length, not including options
+  static constexpr uint8_t MAX_OPTIONS_LENGTH = 40; // Most option bytes the data offset can describe
+  static constexpr uint8_t TIMESTAMPS_SPACE = 12;    // Option bytes taken by the timestamps, with padding
 
   // Return a string containing a summary in human-readable format
   std::string to_string() const;
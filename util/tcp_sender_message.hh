@@ -2,12 +2,14 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
  *
- * It contains five fields:
+ * It contains seven fields:
  *
  * 1) The sequence number (seqno) of the beginning of the segment. If the SYN flag is set, this is the
  *    sequence number of the SYN flag. Otherwise, it's the sequence number of the beginning of the payload.
@@ -20,6 +22,12 @@
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
  * 5) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 6) The SYN options the sender offers for the connection: SACK_permitted says the receiver may
+ *    send SACK blocks back (RFC 2018). Only meaningful on a segment with SYN set.
+ *
+ * 7) The timestamp (TSval, RFC 7323): the sender's clock when the segment was sent, in milliseconds.
+ *    Offered on the SYN, and carried by every later segment once the peer has echoed one back.
  */
 
 struct TCPSenderMessage
@@ -32,6 +40,10 @@ struct TCPSenderMessage
 
   bool RST {};
 
+  bool SACK_permitted {};
+
+  std::optional<uint32_t> timestamp {};
+
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }
 };